@@ -0,0 +1,19 @@
+#ifndef LEX_YY_H
+#define LEX_YY_H
+#include "config.h"
+#include "bxstring.h"
+typedef struct {
+    int yyerrcnt;
+    char sdel;
+    char sesc;
+} pass_to_flex;
+#define LEX_SDELIM  "\"~'`!@%&*=:;<>?/|.\\"
+#define LEX_SDELIM_RECOMMENDED  "\"~'!|"
+void inflate_inbuf(void *yyscanner, const bxstr_t *configfile);
+typedef void *yyscan_t;
+int yylex_init(yyscan_t *s);
+int yylex_init_extra(pass_to_flex *extra, yyscan_t *s);
+void yyset_in(FILE *f, yyscan_t s);
+int yylex_destroy(yyscan_t s);
+int yyget_lineno(yyscan_t s);
+#endif
@@ -0,0 +1,1713 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 1
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "parser.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_YPARENT = 3,                    /* YPARENT  */
+  YYSYMBOL_YSHAPES = 4,                    /* YSHAPES  */
+  YYSYMBOL_YELASTIC = 5,                   /* YELASTIC  */
+  YYSYMBOL_YPADDING = 6,                   /* YPADDING  */
+  YYSYMBOL_YSAMPLE = 7,                    /* YSAMPLE  */
+  YYSYMBOL_YENDSAMPLE = 8,                 /* YENDSAMPLE  */
+  YYSYMBOL_YBOX = 9,                       /* YBOX  */
+  YYSYMBOL_YEND = 10,                      /* YEND  */
+  YYSYMBOL_YUNREC = 11,                    /* YUNREC  */
+  YYSYMBOL_YREPLACE = 12,                  /* YREPLACE  */
+  YYSYMBOL_YREVERSE = 13,                  /* YREVERSE  */
+  YYSYMBOL_YTO = 14,                       /* YTO  */
+  YYSYMBOL_YWITH = 15,                     /* YWITH  */
+  YYSYMBOL_YCHGDEL = 16,                   /* YCHGDEL  */
+  YYSYMBOL_YTAGS = 17,                     /* YTAGS  */
+  YYSYMBOL_KEYWORD = 18,                   /* KEYWORD  */
+  YYSYMBOL_BXWORD = 19,                    /* BXWORD  */
+  YYSYMBOL_ASCII_ID = 20,                  /* ASCII_ID  */
+  YYSYMBOL_STRING = 21,                    /* STRING  */
+  YYSYMBOL_FILENAME = 22,                  /* FILENAME  */
+  YYSYMBOL_SHAPE = 23,                     /* SHAPE  */
+  YYSYMBOL_YNUMBER = 24,                   /* YNUMBER  */
+  YYSYMBOL_YRXPFLAG = 25,                  /* YRXPFLAG  */
+  YYSYMBOL_YDELIMSPEC = 26,                /* YDELIMSPEC  */
+  YYSYMBOL_27_ = 27,                       /* ','  */
+  YYSYMBOL_28_ = 28,                       /* '('  */
+  YYSYMBOL_29_ = 29,                       /* ')'  */
+  YYSYMBOL_30_ = 30,                       /* '{'  */
+  YYSYMBOL_31_ = 31,                       /* '}'  */
+  YYSYMBOL_YYACCEPT = 32,                  /* $accept  */
+  YYSYMBOL_first_rule = 33,                /* first_rule  */
+  YYSYMBOL_34_1 = 34,                      /* $@1  */
+  YYSYMBOL_parent_def = 35,                /* parent_def  */
+  YYSYMBOL_config_file = 36,               /* config_file  */
+  YYSYMBOL_design_or_error = 37,           /* design_or_error  */
+  YYSYMBOL_alias = 38,                     /* alias  */
+  YYSYMBOL_alias_list = 39,                /* alias_list  */
+  YYSYMBOL_design_id = 40,                 /* design_id  */
+  YYSYMBOL_design = 41,                    /* design  */
+  YYSYMBOL_42_2 = 42,                      /* $@2  */
+  YYSYMBOL_layout = 43,                    /* layout  */
+  YYSYMBOL_tag_entry = 44,                 /* tag_entry  */
+  YYSYMBOL_tag_list = 45,                  /* tag_list  */
+  YYSYMBOL_entry = 46,                     /* entry  */
+  YYSYMBOL_block = 47,                     /* block  */
+  YYSYMBOL_rflag = 48,                     /* rflag  */
+  YYSYMBOL_elist = 49,                     /* elist  */
+  YYSYMBOL_elist_entry = 50,               /* elist_entry  */
+  YYSYMBOL_slist = 51,                     /* slist  */
+  YYSYMBOL_slist_entry = 52,               /* slist_entry  */
+  YYSYMBOL_shape_def = 53,                 /* shape_def  */
+  YYSYMBOL_shape_lines = 54,               /* shape_lines  */
+  YYSYMBOL_wlist = 55,                     /* wlist  */
+  YYSYMBOL_wlist_entry = 56                /* wlist_entry  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+/* Unqualified %code blocks.  */
+#line 71 "../src/parser.y"
+
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unictype.h>
+
+#include "logging.h"
+#include "shape.h"
+#include "tools.h"
+#include "parsing.h"
+#include "parser.h"
+#include "lex.yy.h"
+#include "parsecode.h"
+#include "unicode.h"
+
+
+/** required for bison-flex bridge */
+#define scanner bison_args->lexer_state
+
+/** invoke a parsecode action and react to its return code */
+#define invoke_action(action) {   \
+    int rc = (action);            \
+    if (rc == RC_ERROR) {         \
+        YYERROR;                  \
+    } else if (rc == RC_ABORT) {  \
+        YYABORT;                  \
+    } else if (rc == RC_ACCEPT) { \
+        YYACCEPT;                 \
+    }                             \
+}
+
+
+#line 194 "parser.c"
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   94
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  32
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  25
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  53
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  95
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   281
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      28,    29,     2,     2,    27,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    30,     2,    31,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   160,   160,   160,   192,   197,   197,   197,   197,   200,
+     200,   217,   222,   222,   224,   224,   226,   234,   233,   244,
+     244,   244,   244,   247,   252,   252,   255,   260,   277,   282,
+     282,   284,   284,   295,   300,   305,   315,   320,   325,   333,
+     337,   344,   344,   347,   355,   355,   358,   377,   386,   393,
+     400,   409,   409,   411
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "YPARENT", "YSHAPES",
+  "YELASTIC", "YPADDING", "YSAMPLE", "YENDSAMPLE", "YBOX", "YEND",
+  "YUNREC", "YREPLACE", "YREVERSE", "YTO", "YWITH", "YCHGDEL", "YTAGS",
+  "KEYWORD", "BXWORD", "ASCII_ID", "STRING", "FILENAME", "SHAPE",
+  "YNUMBER", "YRXPFLAG", "YDELIMSPEC", "','", "'('", "')'", "'{'", "'}'",
+  "$accept", "first_rule", "$@1", "parent_def", "config_file",
+  "design_or_error", "alias", "alias_list", "design_id", "design", "$@2",
+  "layout", "tag_entry", "tag_list", "entry", "block", "rflag", "elist",
+  "elist_entry", "slist", "slist_entry", "shape_def", "shape_lines",
+  "wlist", "wlist_entry", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-49)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-4)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+     -49,    28,    42,   -49,   -49,    12,   -13,   -49,    41,   -49,
+     -49,   -49,   -49,    22,   -49,   -49,   -49,    27,    20,   -49,
+     -49,    26,    33,    29,    30,    31,    35,    32,    32,    34,
+      -9,    43,    44,    45,    -2,   -49,   -49,    27,   -49,    39,
+      40,    47,    60,   -49,    48,    49,   -49,   -49,    50,   -49,
+     -49,   -49,   -49,    52,   -49,   -49,   -49,    46,   -10,   -49,
+     -49,     2,   -49,    51,   -11,   -49,   -49,    58,    62,   -49,
+      19,   -49,     1,   -49,   -49,   -49,    40,   -49,   -49,   -49,
+     -49,    56,    57,    50,   -49,   -49,   -49,    25,   -49,   -49,
+     -49,   -49,    59,   -49,   -49
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       2,     0,     0,     1,    10,     0,     0,     8,     0,     6,
+       9,     4,    16,    14,    17,     7,     5,     0,     0,    11,
+      12,    15,     0,     0,     0,     0,     0,    40,    40,     0,
+       0,     0,     0,     0,     0,    21,    22,     0,    27,     0,
+       0,     0,     0,    39,     0,     0,    28,    23,     0,    30,
+      26,    31,    32,     0,    19,    20,    13,     0,     0,    45,
+      43,     0,    42,     0,     0,    52,    33,     0,     0,    24,
+       0,    18,     0,    46,    34,    44,     0,    35,    53,    38,
+      51,     0,     0,     0,    29,    50,    48,     0,    41,    36,
+      37,    25,     0,    47,    49
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+     -49,   -49,   -49,    71,   -49,    73,    53,   -49,   -49,   -49,
+     -49,   -49,   -48,   -49,    54,    55,    63,   -49,     6,   -49,
+      36,   -49,   -49,   -49,    21
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     1,     2,     7,     8,     9,    20,    21,    14,    10,
+      18,    34,    49,    70,    35,    36,    44,    61,    62,    58,
+      59,    73,    87,    64,    65
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      69,    22,    23,    24,    25,    26,    12,    13,    53,    63,
+      27,    28,    47,    57,    29,    30,    31,    32,    33,    48,
+      79,    74,    85,    22,    23,    24,    25,    26,     3,    76,
+      86,    77,    27,    28,    11,    91,    29,    30,    31,    32,
+      33,    -3,     4,     4,     5,     5,    83,    19,    84,    17,
+       6,     6,    92,    37,    93,    38,    42,    43,    40,    39,
+      46,    41,    57,    60,    50,    51,    52,    63,    66,    67,
+      68,    47,    71,    81,    72,    78,    82,    89,    90,    15,
+      94,    16,    88,     0,     0,    80,     0,     0,    54,    55,
+      56,    45,     0,     0,    75
+};
+
+static const yytype_int8 yycheck[] =
+{
+      48,     3,     4,     5,     6,     7,    19,    20,    10,    20,
+      12,    13,    21,    23,    16,    17,    18,    19,    20,    28,
+      31,    31,    21,     3,     4,     5,     6,     7,     0,    27,
+      29,    29,    12,    13,    22,    83,    16,    17,    18,    19,
+      20,     0,     1,     1,     3,     3,    27,    20,    29,    27,
+       9,     9,    27,    27,    29,    22,    21,    25,    28,    30,
+      26,    30,    23,    23,    21,    21,    21,    20,     8,    21,
+      21,    21,    20,    15,    28,    24,    14,    21,    21,     8,
+      21,     8,    76,    -1,    -1,    64,    -1,    -1,    34,    34,
+      37,    28,    -1,    -1,    58
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    33,    34,     0,     1,     3,     9,    35,    36,    37,
+      41,    22,    19,    20,    40,    35,    37,    27,    42,    20,
+      38,    39,     3,     4,     5,     6,     7,    12,    13,    16,
+      17,    18,    19,    20,    43,    46,    47,    27,    22,    30,
+      28,    30,    21,    25,    48,    48,    26,    21,    28,    44,
+      21,    21,    21,    10,    46,    47,    38,    23,    51,    52,
+      23,    49,    50,    20,    55,    56,     8,    21,    21,    44,
+      45,    20,    28,    53,    31,    52,    27,    29,    24,    31,
+      56,    15,    14,    27,    29,    21,    29,    54,    50,    21,
+      21,    44,    27,    29,    21
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    32,    34,    33,    35,    36,    36,    36,    36,    37,
+      37,    38,    39,    39,    40,    40,    40,    42,    41,    43,
+      43,    43,    43,    44,    45,    45,    46,    46,    46,    46,
+      46,    46,    46,    47,    47,    47,    47,    47,    47,    48,
+      48,    49,    49,    50,    51,    51,    52,    53,    53,    54,
+      54,    55,    55,    56
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     0,     2,     2,     2,     1,     2,     1,     1,
+       1,     1,     1,     3,     1,     3,     1,     0,     6,     2,
+       2,     1,     1,     1,     1,     3,     2,     2,     2,     4,
+       2,     2,     2,     3,     4,     4,     5,     5,     4,     1,
+       0,     3,     1,     1,     2,     1,     2,     3,     2,     3,
+       1,     2,     1,     2
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (bison_args, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, bison_args); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, pass_to_bison *bison_args)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (bison_args);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, pass_to_bison *bison_args)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep, bison_args);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, pass_to_bison *bison_args)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], bison_args);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, bison_args); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, pass_to_bison *bison_args)
+{
+  YY_USE (yyvaluep);
+  YY_USE (bison_args);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (pass_to_bison *bison_args)
+{
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval, scanner);
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* $@1: %empty  */
+#line 160 "../src/parser.y"
+    {
+        invoke_action(action_init_parser(bison_args));
+    }
+#line 1219 "parser.c"
+    break;
+
+  case 3: /* first_rule: $@1 config_file  */
+#line 165 "../src/parser.y"
+    {
+        /*
+         *  Clean up parser data structures
+         */
+        design_t *tmp;
+
+        if (bison_args->design_idx == 0) {
+            BFREE (bison_args->designs);
+            bison_args->num_designs = 0;
+            if (!opt.design_choice_by_user && bison_args->num_parent_configs == 0) {
+                fprintf(stderr, "%s: no valid data in config file -- %s\n", PROJECT,
+                        bxs_to_output(bison_args->config_file));
+                YYABORT;
+            }
+            YYACCEPT;
+        }
+
+        --(bison_args->design_idx);
+        bison_args->num_designs = bison_args->design_idx + 1;
+        tmp = (design_t *) realloc (bison_args->designs, (bison_args->num_designs) * sizeof(design_t));
+        if (!tmp) {
+            perror (PROJECT);
+            YYABORT;
+        }
+        bison_args->designs = tmp;
+    }
+#line 1250 "parser.c"
+    break;
+
+  case 4: /* parent_def: YPARENT FILENAME  */
+#line 193 "../src/parser.y"
+    {
+        invoke_action(action_parent_config(bison_args, (yyvsp[0].s)));
+    }
+#line 1258 "parser.c"
+    break;
+
+  case 10: /* design_or_error: error  */
+#line 201 "../src/parser.y"
+    {
+        /* reset alias list, as those are collected even when speedmode is on */
+        log_debug(__FILE__, PARSER, " Parser: Discarding token [skipping=%s, speeding=%s]\n",
+                bison_args->skipping ? "true" : "false", bison_args->speeding ? "true" : "false");
+        if (curdes.aliases[0] != NULL) {
+            BFREE(curdes.aliases);
+            curdes.aliases = (char **) calloc(1, sizeof(char *));
+        }
+        if (!bison_args->speeding && !bison_args->skipping) {
+            recover(bison_args);
+            yyerror(bison_args, "skipping to next design");
+            bison_args->skipping = 1;
+        }
+    }
+#line 1277 "parser.c"
+    break;
+
+  case 11: /* alias: ASCII_ID  */
+#line 218 "../src/parser.y"
+    {
+        invoke_action(action_add_alias(bison_args, (yyvsp[0].ascii)));
+    }
+#line 1285 "parser.c"
+    break;
+
+  case 16: /* design_id: BXWORD  */
+#line 227 "../src/parser.y"
+    {
+        yyerror(bison_args, "box design name must consist of printable standard ASCII characters.");
+        YYERROR;
+    }
+#line 1294 "parser.c"
+    break;
+
+  case 17: /* $@2: %empty  */
+#line 234 "../src/parser.y"
+    {
+        invoke_action(action_start_parsing_design(bison_args, (yyvsp[0].ascii)));
+    }
+#line 1302 "parser.c"
+    break;
+
+  case 18: /* design: YBOX design_id $@2 layout YEND ASCII_ID  */
+#line 238 "../src/parser.y"
+    {
+        invoke_action(action_add_design(bison_args, (yyvsp[-4].ascii), (yyvsp[0].ascii)));
+    }
+#line 1310 "parser.c"
+    break;
+
+  case 23: /* tag_entry: STRING  */
+#line 248 "../src/parser.y"
+    {
+        tag_record(bison_args, (yyvsp[0].s));    /* discard return code (we print warnings, but tolerate the problem) */
+    }
+#line 1318 "parser.c"
+    break;
+
+  case 26: /* entry: KEYWORD STRING  */
+#line 256 "../src/parser.y"
+    {
+        invoke_action(action_record_keyword(bison_args, (yyvsp[-1].ascii), (yyvsp[0].s)));
+    }
+#line 1326 "parser.c"
+    break;
+
+  case 27: /* entry: YPARENT FILENAME  */
+#line 261 "../src/parser.y"
+    {
+        /*
+         * Called when PARENT appears as a key inside a box design. That's a user mistake, but not an error.
+         */
+        bxstr_t *filename = (yyvsp[0].s);
+        if (filename->memory[0] != filename->memory[filename->num_chars - 1] || uc_is_alnum(filename->memory[0])) {
+            yyerror(bison_args, "string expected");
+            YYERROR;
+        }
+        else if (is_debug_logging(PARSER)) {
+            char *out_filename = bxs_to_output(filename);
+            log_debug(__FILE__, PARSER, " Parser: Discarding entry [%s = %s].\n", "parent", out_filename);
+            BFREE(out_filename);
+        }
+    }
+#line 1346 "parser.c"
+    break;
+
+  case 28: /* entry: YCHGDEL YDELIMSPEC  */
+#line 278 "../src/parser.y"
+    {
+        /* string delimiters were changed - this is a lexer thing. ignore here. */
+    }
+#line 1354 "parser.c"
+    break;
+
+  case 32: /* entry: ASCII_ID STRING  */
+#line 285 "../src/parser.y"
+    {
+        if (is_debug_logging(PARSER)) {
+            char *out_string = bxs_to_output((yyvsp[0].s));
+            log_debug(__FILE__, PARSER, " Parser: Discarding entry [%s = %s].\n", (yyvsp[-1].ascii), out_string);
+            BFREE(out_string);
+        }
+    }
+#line 1366 "parser.c"
+    break;
+
+  case 33: /* block: YSAMPLE STRING YENDSAMPLE  */
+#line 296 "../src/parser.y"
+    {
+        invoke_action(action_sample_block(bison_args, (yyvsp[-1].s)));
+    }
+#line 1374 "parser.c"
+    break;
+
+  case 34: /* block: YSHAPES '{' slist '}'  */
+#line 301 "../src/parser.y"
+    {
+        invoke_action(action_finalize_shapes(bison_args));
+    }
+#line 1382 "parser.c"
+    break;
+
+  case 35: /* block: YELASTIC '(' elist ')'  */
+#line 306 "../src/parser.y"
+    {
+        ++(bison_args->num_mandatory);
+        if (++(bison_args->time_for_se_check) > 1) {
+            if (perform_se_check(bison_args) != 0) {
+                YYERROR;
+            }
+        }
+    }
+#line 1395 "parser.c"
+    break;
+
+  case 36: /* block: YREPLACE rflag STRING YWITH STRING  */
+#line 316 "../src/parser.y"
+    {
+        invoke_action(action_add_regex_rule(bison_args, "rep", &curdes.reprules, &curdes.num_reprules, (yyvsp[-2].s), (yyvsp[0].s), (yyvsp[-3].c)));
+    }
+#line 1403 "parser.c"
+    break;
+
+  case 37: /* block: YREVERSE rflag STRING YTO STRING  */
+#line 321 "../src/parser.y"
+    {
+        invoke_action(action_add_regex_rule(bison_args, "rev", &curdes.revrules, &curdes.num_revrules, (yyvsp[-2].s), (yyvsp[0].s), (yyvsp[-3].c)));
+    }
+#line 1411 "parser.c"
+    break;
+
+  case 38: /* block: YPADDING '{' wlist '}'  */
+#line 326 "../src/parser.y"
+    {
+        log_debug(__FILE__, PARSER, "Padding set to (l%d o%d r%d u%d)\n",
+                curdes.padding[BLEF], curdes.padding[BTOP], curdes.padding[BRIG], curdes.padding[BBOT]);
+    }
+#line 1420 "parser.c"
+    break;
+
+  case 39: /* rflag: YRXPFLAG  */
+#line 334 "../src/parser.y"
+    {
+        (yyval.c) = (yyvsp[0].c);
+    }
+#line 1428 "parser.c"
+    break;
+
+  case 40: /* rflag: %empty  */
+#line 338 "../src/parser.y"
+    {
+        (yyval.c) = 'g';
+    }
+#line 1436 "parser.c"
+    break;
+
+  case 43: /* elist_entry: SHAPE  */
+#line 348 "../src/parser.y"
+    {
+        log_debug(__FILE__, PARSER, "Marked \'%s\' shape as elastic\n", shape_name[(int) (yyvsp[0].shape)]);
+        curdes.shape[(yyvsp[0].shape)].elastic = 1;
+    }
+#line 1445 "parser.c"
+    break;
+
+  case 46: /* slist_entry: SHAPE shape_def  */
+#line 359 "../src/parser.y"
+    {
+        log_debug(__FILE__, PARSER, "Adding shape spec for \'%s\' (width %d height %d)\n",
+                shape_name[(yyvsp[-1].shape)], (int) (yyvsp[0].sentry).width, (int) (yyvsp[0].sentry).height);
+
+        if (isempty (curdes.shape + (yyvsp[-1].shape))) {
+            curdes.shape[(yyvsp[-1].shape)] = (yyvsp[0].sentry);
+            if (!isdeepempty(&((yyvsp[0].sentry)))) {
+                ++(bison_args->num_shapespec);
+            }
+        }
+        else {
+            yyerror(bison_args, "duplicate specification for %s shape", shape_name[(yyvsp[-1].shape)]);
+            YYERROR;
+        }
+    }
+#line 1465 "parser.c"
+    break;
+
+  case 47: /* shape_def: '(' shape_lines ')'  */
+#line 378 "../src/parser.y"
+    {
+        if ((yyvsp[-1].sentry).width == 0 || (yyvsp[-1].sentry).height == 0) {
+            yyerror(bison_args, "minimum shape dimension is 1x1 - clearing");
+            freeshape (&((yyvsp[-1].sentry)));
+        }
+        (yyval.sentry) = (yyvsp[-1].sentry);
+    }
+#line 1477 "parser.c"
+    break;
+
+  case 48: /* shape_def: '(' ')'  */
+#line 387 "../src/parser.y"
+    {
+        (yyval.sentry) = SENTRY_INITIALIZER;
+    }
+#line 1485 "parser.c"
+    break;
+
+  case 49: /* shape_lines: shape_lines ',' STRING  */
+#line 394 "../src/parser.y"
+    {
+        sentry_t rval = (yyvsp[-2].sentry);
+        invoke_action(action_add_shape_line(bison_args, &rval, (yyvsp[0].s)));
+        (yyval.sentry) = rval;
+    }
+#line 1495 "parser.c"
+    break;
+
+  case 50: /* shape_lines: STRING  */
+#line 401 "../src/parser.y"
+    {
+        sentry_t rval;
+        invoke_action(action_first_shape_line(bison_args, (yyvsp[0].s), &rval));
+        (yyval.sentry) = rval;
+    }
+#line 1505 "parser.c"
+    break;
+
+  case 53: /* wlist_entry: ASCII_ID YNUMBER  */
+#line 412 "../src/parser.y"
+    {
+        invoke_action(action_padding_entry(bison_args, (yyvsp[-1].ascii), (yyvsp[0].num)));
+    }
+#line 1513 "parser.c"
+    break;
+
+
+#line 1517 "parser.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (bison_args, YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, bison_args);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, bison_args);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (bison_args, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, bison_args);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, bison_args);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 418 "../src/parser.y"
+
+
+
+/* vim: set sw=4 cindent: */
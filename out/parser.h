@@ -0,0 +1,184 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_PARSER_H_INCLUDED
+# define YY_YY_PARSER_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 1 "../src/parser.y"
+
+/*
+ * boxes - Command line filter to draw/remove ASCII boxes around text
+ * Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License, version 3, as published by the Free Software Foundation.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ */
+
+/*
+ * Yacc parser for boxes configuration files
+ */
+
+#include "config.h"
+#include "boxes.h"
+#include "bxstring.h"
+
+
+/** all the arguments which we pass to the bison parser */
+typedef struct {
+    /** bison will store the parsed designs here, also allocating memory as required */
+    design_t *designs;
+
+    /** the size of `*designs` */
+    size_t num_designs;
+
+    /** index into `*designs` */
+    int design_idx;
+
+    /** Box designs already parsed from child config files, if any. Else NULL */
+    design_t *child_configs;
+
+    /** the size of `*child_configs` */
+    size_t num_child_configs;
+
+    /** the path to the config file we are parsing */
+    bxstr_t *config_file;
+
+    int num_mandatory;
+
+    int time_for_se_check;
+
+    /** number of user-specified shapes */
+    int num_shapespec;
+
+    /** used to limit "skipping" msgs */
+    int skipping;
+
+    /** true if we're skipping designs, but no error */
+    int speeding;
+
+    /** names of config files specified via "parent" */
+    bxstr_t **parent_configs;
+
+    /** number of parent config files (size of parent_configs array) */
+    size_t num_parent_configs;
+
+    /** the flex scanner state, which is explicitly passed to reentrant bison */
+    void *lexer_state;
+} pass_to_bison;
+
+
+#line 119 "parser.h"
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    YPARENT = 258,                 /* YPARENT  */
+    YSHAPES = 259,                 /* YSHAPES  */
+    YELASTIC = 260,                /* YELASTIC  */
+    YPADDING = 261,                /* YPADDING  */
+    YSAMPLE = 262,                 /* YSAMPLE  */
+    YENDSAMPLE = 263,              /* YENDSAMPLE  */
+    YBOX = 264,                    /* YBOX  */
+    YEND = 265,                    /* YEND  */
+    YUNREC = 266,                  /* YUNREC  */
+    YREPLACE = 267,                /* YREPLACE  */
+    YREVERSE = 268,                /* YREVERSE  */
+    YTO = 269,                     /* YTO  */
+    YWITH = 270,                   /* YWITH  */
+    YCHGDEL = 271,                 /* YCHGDEL  */
+    YTAGS = 272,                   /* YTAGS  */
+    KEYWORD = 273,                 /* KEYWORD  */
+    BXWORD = 274,                  /* BXWORD  */
+    ASCII_ID = 275,                /* ASCII_ID  */
+    STRING = 276,                  /* STRING  */
+    FILENAME = 277,                /* FILENAME  */
+    SHAPE = 278,                   /* SHAPE  */
+    YNUMBER = 279,                 /* YNUMBER  */
+    YRXPFLAG = 280,                /* YRXPFLAG  */
+    YDELIMSPEC = 281               /* YDELIMSPEC  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 119 "../src/parser.y"
+
+    bxstr_t *s;
+    char *ascii;
+    char c;
+    shape_t shape;
+    sentry_t sentry;
+    int num;
+
+#line 171 "parser.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+
+
+int yyparse (pass_to_bison *bison_args);
+
+
+#endif /* !YY_YY_PARSER_H_INCLUDED  */
@@ -19,6 +19,7 @@
 #include <ncurses.h>
 #endif
 #include <locale.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,6 +32,7 @@
 #include "boxes.h"
 #include "bxstring.h"
 #include "cmdline.h"
+#include "detect.h"
 #include "discovery.h"
 #include "generate.h"
 #include "input.h"
@@ -264,33 +266,61 @@ static void apply_expected_size()
 
 
 
+/**
+ * Copy lines from the input file to the output file as they are, without decoding them. Lines longer than
+ * `LINE_MAX_BYTES` are copied in pieces which count as separate lines, just like when input is read for processing.
+ * @param num_lines the maximum number of lines to copy
+ */
+static void copy_input_lines(size_t num_lines)
+{
+    char buf[LINE_MAX_BYTES + 3];
+    for (size_t i = 0; i < num_lines && fgets(buf, LINE_MAX_BYTES + 2, opt.infile); i++) {
+        fputs(buf, opt.outfile);
+    }
+}
+
+
+
+/**
+ * Copy the input lines following the region given via `--region` to the output. Called only when processing the
+ * region succeeded, so that the lines are output after its result. Does nothing if no region was specified.
+ */
+static void copy_input_after_region()
+{
+    if (opt.region_first > 0) {
+        copy_input_lines(SIZE_MAX);
+    }
+}
+
+
+
 /**
  * Read all input lines and store the result in the global `input` structure. May exit the program.
+ * When a region of lines was specified, the lines before the region are copied to the output first.
  */
 static void handle_input()
 {
     log_debug(__FILE__, MAIN, "Reading all input ...\n");
 
-    input_t *raw_input = NULL;
-    if (opt.mend != 0) {
-        raw_input = read_all_input();
-        if (raw_input == NULL) {
-            exit(EXIT_FAILURE);
-        }
+    if (opt.region_first > 0) {
+        copy_input_lines(opt.region_first - 1);
     }
-    if (analyze_input(raw_input ? raw_input : &input)) {
+    input_t *raw_input = read_all_input();
+    if (raw_input == NULL) {
         exit(EXIT_FAILURE);
     }
-    if (raw_input) {
-        memcpy(&input, raw_input, sizeof(input_t));
-        BFREE(raw_input);
+    if (analyze_input(raw_input)) {
+        exit(EXIT_FAILURE);
     }
+    memcpy(&input, raw_input, sizeof(input_t));
+    BFREE(raw_input);
 
     if (is_debug_logging(MAIN)) {
         log_debug(__FILE__, MAIN, "Effective encoding: %s\n", encoding);
         print_input_lines(NULL);
     }
     if (input.num_lines == 0) {
+        copy_input_after_region();
         exit(EXIT_SUCCESS);
     }
 }
@@ -363,7 +393,7 @@ static void handle_generate_box()
 {
     log_debug(__FILE__, MAIN, "Generating Box ...\n");
 
-    sentry_t *thebox = (sentry_t *) calloc(NUM_SIDES, sizeof(sentry_t));
+    box_t *thebox = (box_t *) calloc(1, sizeof(box_t));
     if (thebox == NULL) {
         perror(PROJECT);
         exit(EXIT_FAILURE);
@@ -377,6 +407,78 @@ static void handle_generate_box()
 
 
 
+/**
+ * Generate one box for each of the box sizes requested via `-s`, and write them to the output one after another,
+ * separated by a line consisting of a form feed character. The input is read and analyzed only once. When two boxes
+ * end up with the same width, the top and bottom sides of the earlier box are reused; the same applies to the left and
+ * right sides for boxes of the same height. May exit the program.
+ * @param saved_designwidth the minimum width of the design before the requested box size was applied
+ * @param saved_designheight the minimum height of the design before the requested box size was applied
+ * @param saved_padding the padding of the design before the padding from the command line was applied
+ */
+static void handle_generate_boxes(size_t saved_designwidth, size_t saved_designheight, int *saved_padding)
+{
+    box_t *boxes = (box_t *) calloc(opt.num_sizes, sizeof(box_t));
+    size_t *widths = (size_t *) calloc(opt.num_sizes, sizeof(size_t));
+    size_t *heights = (size_t *) calloc(opt.num_sizes, sizeof(size_t));
+    if (boxes == NULL || widths == NULL || heights == NULL) {
+        perror(PROJECT);
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < opt.num_sizes; i++) {
+        log_debug(__FILE__, MAIN, "Generating Box %d of %d ...\n", (int) i + 1, (int) opt.num_sizes);
+
+        opt.design->minwidth = saved_designwidth;
+        opt.design->minheight = saved_designheight;
+        memcpy(opt.design->padding, saved_padding, NUM_SIDES * sizeof(int));
+        opt.reqwidth = opt.reqwidths[i];
+        opt.reqheight = opt.reqheights[i];
+        apply_expected_size();
+        adjust_size_and_padding();
+        widths[i] = opt.design->minwidth;
+        heights[i] = opt.design->minheight;
+
+        box_t *horiz_from = NULL;
+        box_t *vert_from = NULL;
+        for (size_t j = 0; j < i; j++) {
+            if (horiz_from == NULL && widths[j] == widths[i]) {
+                horiz_from = boxes + j;
+            }
+            if (vert_from == NULL && heights[j] == heights[i]) {
+                vert_from = boxes + j;
+            }
+        }
+
+        box_t *thebox = boxes + i;
+        if (generate_box_reusing(thebox, horiz_from, vert_from)) {
+            exit(EXIT_FAILURE);
+        }
+        if (i > 0) {
+            fprintf(opt.outfile, "%s\f%s", input.final_newline ? "" : opt.eol, opt.eol);
+        }
+        output_box(thebox);
+    }
+
+    /* Only the top and bottom sides are allocated, and they are freed once by the box which generated them. The left
+       and right sides just point to the shapes of the design. */
+    for (size_t i = 0; i < opt.num_sizes; i++) {
+        int reused = 0;
+        for (size_t j = 0; j < i && !reused; j++) {
+            reused = widths[j] == widths[i];
+        }
+        if (!reused) {
+            freeshape(&(boxes[i].top));
+            freeshape(&(boxes[i].bottom));
+        }
+    }
+    BFREE(boxes);
+    BFREE(widths);
+    BFREE(heights);
+}
+
+
+
 /**
  * Remove box. May exit the program.
  */
@@ -391,6 +493,13 @@ static void handle_remove_box()
             opt.killblank = 1;
         }
     }
+    if (opt.remove_all) {
+        if (remove_all_boxes()) {   /* also applies the reversion rules, but only to the box bodies */
+            exit(EXIT_FAILURE);
+        }
+        output_input();
+        return;
+    }
     int rc = remove_box();
     if (rc) {
         exit(EXIT_FAILURE);
@@ -399,7 +508,470 @@ static void handle_remove_box()
     if (rc) {
         exit(EXIT_FAILURE);
     }
-    output_input(opt.mend > 0);
+    if (!opt.mend) {
+        output_input();
+    }
+}
+
+
+
+/**
+ * Mend box. The box is removed, and a new box is drawn around the remaining text, which is passed on in memory.
+ * May exit the program.
+ * @param saved_designwidth the minimum width of the design before any adjustments were made for removal
+ * @param saved_designheight the minimum height of the design before any adjustments were made for removal
+ */
+static void handle_mend_box(size_t saved_designwidth, size_t saved_designheight)
+{
+    handle_remove_box();
+
+    log_debug(__FILE__, MAIN, "Mending Box ...\n");
+    opt.r = 0;
+    opt.design->minwidth = saved_designwidth;
+    opt.design->minheight = saved_designheight;
+
+    if (analyze_mended_input(&input)) {
+        exit(EXIT_FAILURE);
+    }
+    if (is_debug_logging(MAIN)) {
+        print_input_lines(NULL);
+    }
+    if (input.num_lines == 0) {
+        copy_input_after_region();
+        exit(EXIT_SUCCESS);
+    }
+
+    adjust_size_and_padding();
+    handle_generate_box();
+}
+
+
+
+/**
+ * Print the result of design autodetection for the current input: the winning design and its score, followed by the
+ * best runner-up designs and their scores.
+ * @param file_name the name of the input file, printed as a prefix; NULL for no prefix
+ * @return 1 if a design was detected, 0 if not
+ */
+static int report_detected_design(const char *file_name)
+{
+    long *scores = (long *) calloc(num_designs, sizeof(long));
+    if (scores == NULL) {
+        perror(PROJECT);
+        exit(EXIT_FAILURE);
+    }
+    design_t *winner = input.num_lines > 0 ? autodetect_design_scored(scores) : NULL;
+
+    if (file_name != NULL) {
+        fprintf(opt.outfile, "%s: ", file_name);
+    }
+    if (winner == NULL) {
+        fprintf(opt.outfile, "(none)%s", opt.eol);
+        BFREE(scores);
+        return 0;
+    }
+
+    fprintf(opt.outfile, "%s (%ld hits)", winner->name, scores[winner - designs]);
+    scores[winner - designs] = 0;
+    for (int r = 0; r < 3; ++r) {                /* up to three runners-up */
+        int best = -1;
+        for (int i = 0; i < num_designs; ++i) {
+            if (scores[i] > 0 && (best < 0 || scores[i] > scores[best])) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        fprintf(opt.outfile, "%s%s (%ld hits)", r == 0 ? ", runner-up: " : ", ", designs[best].name, scores[best]);
+        scores[best] = 0;
+    }
+    fprintf(opt.outfile, "%s", opt.eol);
+
+    BFREE(scores);
+    return 1;
+}
+
+
+
+/**
+ * Read and analyze all input from `opt.infile`, without any of the preparations needed for drawing or removing a box.
+ * The result is stored in the global `input`.
+ */
+static void read_input_for_scan()
+{
+    input_t *raw_input = read_all_input();
+    if (raw_input == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    if (analyze_input(raw_input)) {
+        exit(EXIT_FAILURE);
+    }
+    memcpy(&input, raw_input, sizeof(input_t));
+    BFREE(raw_input);
+}
+
+
+
+/**
+ * Free the lines of the given input, and everything else allocated for them. The input struct itself is not freed,
+ * but reset to all zeroes.
+ * @param in the input to free
+ */
+static void free_input_data(input_t *in)
+{
+    for (size_t i = 0; i < in->num_lines; ++i) {
+        bxs_free(in->lines[i].text);
+        BFREE(in->lines[i].tabpos);
+    }
+    BFREE(in->lines);
+    BFREE(in->visible);
+    memset(in, 0, sizeof(input_t));
+}
+
+
+
+/**
+ * Free the input read by `read_input_for_scan()`, so that the next file can be processed.
+ */
+static void free_input_for_scan()
+{
+    free_input_data(&input);
+}
+
+
+
+/**
+ * Read all input from `opt.infile`, detect the box design, and report it. The input is freed afterwards, so that the
+ * next file can be processed.
+ * @param file_name the name of the input file, printed as a prefix; NULL for no prefix
+ * @return 1 if a design was detected, 0 if not
+ */
+static int detect_design_in_input(const char *file_name)
+{
+    read_input_for_scan();
+    int result = report_detected_design(file_name);
+    free_input_for_scan();
+    return result;
+}
+
+
+
+/**
+ * Detect the box design in each input file and report the results, but do not remove anything (`--detect`).
+ * @return `EXIT_SUCCESS` if a design was detected in every input, `EXIT_FAILURE` otherwise
+ */
+static int handle_detect_only()
+{
+    log_debug(__FILE__, MAIN, "Detecting Box Design ...\n");
+
+    int result = EXIT_SUCCESS;
+    if (opt.infiles == NULL) {
+        if (!detect_design_in_input(NULL)) {
+            result = EXIT_FAILURE;
+        }
+        return result;
+    }
+
+    for (char **file_name = opt.infiles; *file_name != NULL; ++file_name) {
+        opt.infile = strcmp(*file_name, "-") == 0 ? stdin : fopen(*file_name, "r");
+        if (opt.infile == NULL) {
+            bx_fprintf(stderr, "%s: Can\'t open input file -- %s\n", PROJECT, *file_name);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        if (!detect_design_in_input(opt.infiles[1] != NULL ? *file_name : NULL)) {
+            result = EXIT_FAILURE;
+        }
+        if (opt.infile != stdin) {
+            fclose(opt.infile);
+        }
+    }
+    return result;
+}
+
+
+
+/**
+ * Print a string as a JSON string literal, including the quotes.
+ * @param s the string to print
+ */
+static void print_json_string(const char *s)
+{
+    fputc('"', opt.outfile);
+    for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(opt.outfile, "\\%c", *p);
+        }
+        else if (*p < 0x20) {
+            fprintf(opt.outfile, "\\u%04x", *p);
+        }
+        else {
+            fputc(*p, opt.outfile);
+        }
+    }
+    fputc('"', opt.outfile);
+}
+
+
+
+/**
+ * Print one record of the box locator: file name, first and last line of the box (counting from 1), design name, and
+ * match quality.
+ * @param file_name the name of the input file
+ * @param location the position of the box
+ */
+static void print_box_location(const char *file_name, box_location_t *location)
+{
+    if (opt.locate == 'j') {
+        fprintf(opt.outfile, "{\"file\": ");
+        print_json_string(file_name);
+        fprintf(opt.outfile, ", \"start\": %d, \"end\": %d, \"design\": ",
+                (int) location->start_idx + 1, (int) location->end_idx);
+        print_json_string(opt.design->name);
+        fprintf(opt.outfile, ", \"quality\": %d}%s", location->quality, opt.eol);
+    }
+    else {
+        fprintf(opt.outfile, "%s\t%d\t%d\t%s\t%d%s", file_name, (int) location->start_idx + 1,
+                (int) location->end_idx, opt.design->name, location->quality, opt.eol);
+    }
+}
+
+
+
+/**
+ * Read all input from `opt.infile` and report the positions of all boxes in it. Unless a design was chosen by the
+ * user, the design is detected for each input. The input is freed afterwards, so that the next file can be processed.
+ * @param file_name the name of the input file, printed in each record
+ * @return the number of boxes found
+ */
+static size_t locate_boxes_in_input(const char *file_name)
+{
+    read_input_for_scan();
+
+    size_t num_boxes = 0;
+    if (input.num_lines > 0) {
+        if (!opt.design_choice_by_user) {
+            opt.design = autodetect_design();
+        }
+        if (opt.design != NULL) {
+            box_location_t *locations = find_all_boxes(&num_boxes);
+            for (size_t i = 0; i < num_boxes; ++i) {
+                print_box_location(file_name, locations + i);
+            }
+            BFREE(locations);
+        }
+    }
+
+    free_input_for_scan();
+    return num_boxes;
+}
+
+
+
+/**
+ * Report the positions of all boxes in each input file, but do not remove anything (`--locate`).
+ * @return `EXIT_SUCCESS` if at least one box was found and all inputs could be read, `EXIT_FAILURE` otherwise
+ */
+static int handle_locate_only()
+{
+    log_debug(__FILE__, MAIN, "Locating Boxes ...\n");
+
+    if (opt.infiles == NULL) {
+        return locate_boxes_in_input("-") > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int result = EXIT_SUCCESS;
+    size_t num_boxes = 0;
+    for (char **file_name = opt.infiles; *file_name != NULL; ++file_name) {
+        opt.infile = strcmp(*file_name, "-") == 0 ? stdin : fopen(*file_name, "r");
+        if (opt.infile == NULL) {
+            bx_fprintf(stderr, "%s: Can\'t open input file -- %s\n", PROJECT, *file_name);
+            result = EXIT_FAILURE;
+            continue;
+        }
+        num_boxes += locate_boxes_in_input(*file_name);
+        if (opt.infile != stdin) {
+            fclose(opt.infile);
+        }
+    }
+    return num_boxes > 0 ? result : EXIT_FAILURE;
+}
+
+
+
+/**
+ * Make a copy of input which has been read, but not yet analyzed, so that it can be analyzed for another design.
+ * May exit the program.
+ * @param raw_input the input to copy
+ * @return the copy, for which new memory was allocated
+ */
+static input_t *copy_raw_input(const input_t *raw_input)
+{
+    input_t *result = (input_t *) calloc(1, sizeof(input_t));
+    line_t *lines = (line_t *) calloc(BMAX(raw_input->num_lines, (size_t) 1), sizeof(line_t));
+    if (result == NULL || lines == NULL) {
+        perror(PROJECT);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(result, raw_input, sizeof(input_t));
+    result->lines = lines;
+    for (size_t i = 0; i < raw_input->num_lines; ++i) {
+        memcpy(lines + i, raw_input->lines + i, sizeof(line_t));
+        lines[i].text = bxs_strdup(raw_input->lines[i].text);
+        lines[i].tabpos = NULL;
+        if (raw_input->lines[i].tabpos_len > 0) {
+            lines[i].tabpos = (size_t *) malloc(raw_input->lines[i].tabpos_len * sizeof(size_t));
+            if (lines[i].tabpos == NULL) {
+                perror(PROJECT);
+                exit(EXIT_FAILURE);
+            }
+            memcpy(lines[i].tabpos, raw_input->lines[i].tabpos, raw_input->lines[i].tabpos_len * sizeof(size_t));
+        }
+        if (lines[i].text == NULL) {
+            perror(PROJECT);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return result;
+}
+
+
+
+/**
+ * Determine the width of the longest input line after the replacement rules of the current design have been applied
+ * to it. The raw input is analyzed again for this, so it should only be done for designs which have such rules.
+ * May exit the program.
+ * @param raw_input the input as read, but not yet analyzed
+ * @return the length in columns of the longest line
+ */
+static size_t maxline_with_reprules(const input_t *raw_input)
+{
+    input_t *copy = copy_raw_input(raw_input);
+    if (analyze_input(copy)) {
+        exit(EXIT_FAILURE);
+    }
+    size_t result = copy->maxline;
+    free_input_data(copy);
+    BFREE(copy);
+    return result;
+}
+
+
+
+/**
+ * Print one record of the box measurement: design name, width and height of the box, and the distance between the
+ * text block and the top, right, bottom, and left edge of the box.
+ * @param geometry the geometry of the box
+ */
+static void print_box_geometry(const box_geometry_t *geometry)
+{
+    if (opt.measure == 'j') {
+        fprintf(opt.outfile, "{\"design\": ");
+        print_json_string(opt.design->name);
+        fprintf(opt.outfile, ", \"width\": %d, \"height\": %d, "
+                "\"inset\": {\"top\": %d, \"right\": %d, \"bottom\": %d, \"left\": %d}}%s",
+                (int) geometry->width, (int) geometry->height, (int) geometry->inset[BTOP],
+                (int) geometry->inset[BRIG], (int) geometry->inset[BBOT], (int) geometry->inset[BLEF], opt.eol);
+    }
+    else {
+        fprintf(opt.outfile, "%s\t%d\t%d\t%d\t%d\t%d\t%d%s", opt.design->name,
+                (int) geometry->width, (int) geometry->height, (int) geometry->inset[BTOP],
+                (int) geometry->inset[BRIG], (int) geometry->inset[BBOT], (int) geometry->inset[BLEF], opt.eol);
+    }
+}
+
+
+
+/**
+ * Report the size of the box which would be drawn around the given input for every design, unless one was chosen by
+ * the user, and for every box size requested via `-s`. No part of any box is generated. The input is analyzed only
+ * once, except for designs which have replacement rules, because those may change the text.
+ * @param raw_input the input as read, which is not modified
+ * @return `EXIT_SUCCESS` if all boxes could be measured, `EXIT_FAILURE` otherwise
+ */
+static int measure_designs(input_t *raw_input)
+{
+    /* Analyze the input without replacement rules and with the indentation removed, which is good for most designs. */
+    design_t plain_design;
+    memcpy(&plain_design, designs, sizeof(design_t));
+    plain_design.num_reprules = 0;
+    plain_design.indentmode = 'b';
+    opt.design = &plain_design;
+    input_t *plain_input = copy_raw_input(raw_input);
+    if (analyze_input(plain_input)) {
+        free_input_data(plain_input);
+        BFREE(plain_input);
+        return EXIT_FAILURE;
+    }
+    memcpy(&input, plain_input, sizeof(input_t));
+    BFREE(plain_input);
+    size_t plain_maxline = input.maxline;
+
+    int result = EXIT_SUCCESS;
+    size_t num_sizes = BMAX(opt.num_sizes, (size_t) 1);
+    for (int d = 0; d < num_designs; ++d) {
+        opt.design = designs + d;
+        if (opt.indentmode) {
+            opt.design->indentmode = opt.indentmode;
+        }
+        if (opt.design->num_reprules > 0) {
+            input.maxline = maxline_with_reprules(raw_input);
+        }
+        else {
+            input.maxline = plain_maxline + (opt.design->indentmode == 't' ? input.indent : 0);
+        }
+
+        size_t saved_designwidth = opt.design->minwidth;
+        size_t saved_designheight = opt.design->minheight;
+        int saved_padding[NUM_SIDES];
+        memcpy(saved_padding, opt.design->padding, NUM_SIDES * sizeof(int));
+
+        for (size_t i = 0; i < num_sizes; ++i) {
+            opt.design->minwidth = saved_designwidth;
+            opt.design->minheight = saved_designheight;
+            memcpy(opt.design->padding, saved_padding, NUM_SIDES * sizeof(int));
+            if (opt.num_sizes > 0) {
+                opt.reqwidth = opt.reqwidths[i];
+                opt.reqheight = opt.reqheights[i];
+            }
+            apply_expected_size();
+            adjust_size_and_padding();
+
+            box_geometry_t geometry;
+            if (measure_box(&geometry) == 0) {
+                print_box_geometry(&geometry);
+            }
+            else {
+                result = EXIT_FAILURE;
+            }
+        }
+    }
+    return result;
+}
+
+
+
+/**
+ * Report the size of the box which would be drawn around the input, but do not draw it (`--measure`).
+ * @return `EXIT_SUCCESS` if all boxes could be measured, `EXIT_FAILURE` otherwise
+ */
+static int handle_measure_only()
+{
+    log_debug(__FILE__, MAIN, "Measuring Boxes ...\n");
+
+    input_t *raw_input = read_all_input();
+    if (raw_input == NULL) {
+        return EXIT_FAILURE;
+    }
+    int result = EXIT_SUCCESS;
+    if (raw_input->num_lines > 0) {   /* no box is drawn around empty input */
+        result = measure_designs(raw_input);
+    }
+
+    free_input_data(raw_input);
+    BFREE(raw_input);
+    return result;
 }
 
 
@@ -503,8 +1075,9 @@ void enable_ansi_mode() {
 int main(int argc, char *argv[])
 {
     int rc;                           /* general return code */
-    int saved_designwidth;            /* opt.design->minwith backup, used for mending */
-    int saved_designheight;           /* opt.design->minheight backup, used for mending */
+    size_t saved_designwidth;         /* opt.design->minwith backup, used for mending and several box sizes */
+    size_t saved_designheight;        /* opt.design->minheight backup, used for mending and several box sizes */
+    int saved_padding[NUM_SIDES];     /* opt.design->padding backup, used for drawing several box sizes */
 
     /* Temporarily set the system encoding, for proper output of --help text etc. */
     activateSystemEncoding();
@@ -533,33 +1106,55 @@ int main(int argc, char *argv[])
         exit(rc);
     }
 
-    apply_expected_size();
-    if (opt.indentmode) {
-        opt.design->indentmode = opt.indentmode;
+    /* If "--detect" option was given, report the detected box designs and exit. */
+    if (opt.detect) {
+        rc = handle_detect_only();
+        exit(rc);
+    }
+
+    /* If "--locate" option was given, report the positions of all boxes and exit. */
+    if (opt.locate) {
+        rc = handle_locate_only();
+        exit(rc);
     }
+
+    /* If "--measure" option was given, report the size of the box for each design and exit. */
+    if (opt.measure) {
+        rc = handle_measure_only();
+        exit(rc);
+    }
+
     saved_designwidth = opt.design->minwidth;
     saved_designheight = opt.design->minheight;
+    memcpy(saved_padding, opt.design->padding, NUM_SIDES * sizeof(int));
 
-    do {
-        if (opt.mend == 1) {  /* Mending a box works in two phases: */
-            opt.r = 0;        /* opt.mend == 2: remove box          */
-        }
-        --opt.mend;           /* opt.mend == 1: add it back         */
-        opt.design->minwidth = saved_designwidth;
-        opt.design->minheight = saved_designheight;
+    apply_expected_size();
+    if (opt.indentmode) {
+        opt.design->indentmode = opt.indentmode;
+    }
+    if (opt.num_sizes <= 1 || opt.mend || opt.r) {   /* several sizes apply their own, starting from the design */
+        saved_designwidth = opt.design->minwidth;
+        saved_designheight = opt.design->minheight;
+    }
 
-        handle_input();
+    handle_input();
 
-        adjust_size_and_padding();
+    adjust_size_and_padding();
 
-        if (opt.r) {
-            handle_remove_box();
-        }
-        else {
-            handle_generate_box();
-        }
-    } while (opt.mend > 0);
+    if (opt.mend) {
+        handle_mend_box(saved_designwidth, saved_designheight);
+    }
+    else if (opt.r) {
+        handle_remove_box();
+    }
+    else if (opt.num_sizes > 1) {
+        handle_generate_boxes(saved_designwidth, saved_designheight, saved_padding);
+    }
+    else {
+        handle_generate_box();
+    }
 
+    copy_input_after_region();
     return EXIT_SUCCESS;
 }
 
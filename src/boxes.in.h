@@ -134,6 +134,9 @@ typedef struct {                     /* Command line options: */
     int       color;                 /** `--color` or `--no-color`: `force_monochrome`, `color_from_terminal`, or `force_ansi_color` */
     design_t *design;                /** `-d`: currently used box design */
     int       design_choice_by_user; /** `-d`, `-c`: true if design was chosen by user */
+    int       detect;                /** `--detect`: only detect and report the box design of the input */
+    size_t    edited_first;          /** `--edited`: number of the first edited input line (1-based), 0 if not given */
+    size_t    edited_last;           /** `--edited`: number of the last edited input line (1-based) */
     char     *eol;                   /** `-e`: line break to use. Never NULL, default to "\n". */
     int       eol_overridden;        /** `-e`: 0: value in `eol` is the default; 1: value in `eol` specified via `-e` */
     char     *f;                     /** `-f`: config file path */
@@ -141,20 +144,31 @@ typedef struct {                     /* Command line options: */
     char      indentmode;            /** `-i`: 'b', 't', 'n', or '\0' */
     int       killblank;             /** `-k`: kill blank lines, -1 if not set */
     int       l;                     /** `-l`: list available designs */
-    int       mend;                  /** `-m`: 1 if -m is given, 2 in 2nd loop */
+    char      locate;                /** `--locate`: only report the position of each box, 't' (TSV), 'j' (JSON), or '\0' */
+    char      measure;               /** `--measure`: only report the size of the box, 't' (TSV), 'j' (JSON), or '\0' */
+    int       mend;                  /** `-m`: mend box, i.e. remove it and draw it again */
     char     *encoding;              /** `-n`: character encoding override for input and output text */
     int       padding[NUM_SIDES];    /** `-p`: in spaces or lines resp. */
     char    **query;                 /** `-q`: parsed tag query expression passed in via -q; also, special handling of web UI needs */
     int       r;                     /** `-r`: remove box from input */
+    size_t    region_first;          /** `--region`: number of the first input line to process (1-based), 0 for all */
+    size_t    region_last;           /** `--region`: number of the last input line to process (1-based) */
+    int       remove_all;            /** `--remove-all`: remove all boxes from input, keeping the text in between */
     long      reqwidth;              /** `-s`: requested box width */
     long      reqheight;             /** `-s`: requested box height */
+    size_t    num_sizes;             /** `-s`: number of requested box sizes, more than one to draw several boxes */
+    long     *reqwidths;             /** `-s`: requested box widths of all sizes, the first one is `reqwidth` */
+    long     *reqheights;            /** `-s`: requested box heights of all sizes, the first one is `reqheight` */
     int       tabstop;               /** `-t`: tab stop distance */
     char      tabexp;                /** `-t`: tab expansion mode (for leading tabs) */
     int       version_requested;     /** `-v`: request to show version number */
+    size_t    work_limit;            /** `--work-limit`: maximum number of steps for design detection and box removal,
+                                         0 for no limit */
     int      *debug;                 /** `-x debug:`: activate debug logging for given debug log areas */
     int       qundoc;                /** `-x (undoc)`: flag if "(undoc)" was specified, put directly before "debug:" */
     FILE     *infile;
     FILE     *outfile;
+    char    **infiles;               /** `--detect`, `--locate`: NULL-terminated list of input file names, NULL for stdin */
 } opt_t;
 
 extern opt_t opt;
@@ -170,7 +184,8 @@ extern int color_output_enabled;
 
 typedef struct {
     bxstr_t  *text;                  /* text content of the line as a boxes string */
-    uint32_t *cache_visible;         /* only the visible characters of `text`, initially NULL. This is a cache. */
+    int       mono;                  /* flag indicating that `text` contains no invisible characters */
+    size_t    visible_idx;           /* where the visible characters of `text` start in `input.visible` (if not mono) */
     size_t   *tabpos;                /* tab positions in expanded work strings, or NULL if not needed */
     size_t    tabpos_len;            /* number of tabs in a line */
 } line_t;
@@ -181,6 +196,10 @@ typedef struct {
     size_t  maxline;                 /* length in columns of longest input line */
     size_t  indent;                  /* common number of leading spaces found in all input lines */
     int     final_newline;           /* true if the last line of input ends with newline */
+    int     mono;                    /* flag indicating that no line contains invisible characters */
+    uint32_t *visible;               /* the visible characters of all lines which are not mono, each zero-terminated,
+                                        in one buffer; NULL if all lines are mono */
+    size_t  work_spent;              /* number of steps spent on design detection and box removal for this input */
 } input_t;
 
 extern input_t input;
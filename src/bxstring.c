@@ -80,21 +80,73 @@ bxstr_t *bxs_from_ascii(char *pAscii)
 
 
 
-bxstr_t *bxs_from_unicode(uint32_t *pInput)
+/**
+ * Compute all the fields of a `bxstr_t` whose `memory` consists only of printable ASCII characters. The result is the
+ * same as from `analyze_memory()`, but much quicker to obtain, because every character is visible and one column wide.
+ * @param result the string to analyze, whose `memory` is already set
+ * @param len the number of characters in `memory`
+ */
+static void analyze_ascii_memory(bxstr_t *result, size_t len)
 {
-    if (pInput == NULL) {
-        bx_fprintf(stderr, "%s: internal error: bxs_from_unicode() called with NULL\n", PROJECT);
-        return NULL;
+    uint32_t *pInput = result->memory;
+    result->num_chars = len;
+    result->num_chars_visible = len;
+    result->num_chars_invisible = 0;
+    result->num_columns = len;
+    result->ascii = (char *) realloc(result->ascii, (len + 1) * sizeof(char));
+    result->first_char = (size_t *) realloc(result->first_char, (len + 1) * sizeof(size_t));
+    result->visible_char = (size_t *) realloc(result->visible_char, (len + 1) * sizeof(size_t));
+
+    for (size_t idx = 0; idx <= len; idx++) {
+        result->ascii[idx] = (char) (pInput[idx] & 0xff);
+        result->first_char[idx] = idx;
+        result->visible_char[idx] = idx;
+    }
+
+    size_t indent = 0;
+    while (indent < len && pInput[indent] == char_space) {
+        indent++;
+    }
+    size_t trailing = 0;
+    if (indent < len) {
+        while (pInput[len - 1 - trailing] == char_space) {
+            trailing++;
+        }
     }
+    result->indent = indent;
+    result->trailing = trailing;
+}
 
-    bxstr_t *result = (bxstr_t *) calloc(1, sizeof(bxstr_t));
-    result->memory = u32_strdup(pInput);
+
+
+/**
+ * Compute all the fields of a `bxstr_t` from its `memory`. The `ascii`, `first_char`, and `visible_char` arrays are
+ * resized to fit, so they may either be NULL or still belong to the previous contents of the string.
+ * @param result the string to analyze, whose `memory` is already set
+ * @return 0 on success, -1 if an illegal character was encountered
+ */
+static int analyze_memory(bxstr_t *result)
+{
+    uint32_t *pInput = result->memory;
+
+    size_t ascii_chars = 0;
+    while (is_ascii_printable(pInput[ascii_chars])) {
+        ascii_chars++;
+    }
+    if (pInput[ascii_chars] == char_nul) {
+        analyze_ascii_memory(result, ascii_chars);
+        return 0;
+    }
+
+    result->indent = 0;
+    result->num_columns = 0;
     result->num_chars = u32_strlen(pInput);
+    result->num_chars_visible = 0;
+    result->num_chars_invisible = 0;
     size_t ascii_len = ((size_t) u32_strwidth(pInput, encoding)) + 1;
-    result->ascii = (char *) calloc(ascii_len, sizeof(char));
-    size_t map_size = 5;
-    result->first_char = (size_t *) calloc(map_size, sizeof(size_t));
-    result->visible_char = (size_t *) calloc(map_size, sizeof(size_t));
+    result->ascii = (char *) realloc(result->ascii, ascii_len * sizeof(char));
+    result->first_char = (size_t *) realloc(result->first_char, (result->num_chars + 1) * sizeof(size_t));
+    result->visible_char = (size_t *) realloc(result->visible_char, (result->num_chars + 1) * sizeof(size_t));
     char *ascii_ptr = result->ascii;
 
     const uint32_t *rest = pInput;
@@ -106,16 +158,9 @@ bxstr_t *bxs_from_unicode(uint32_t *pInput)
     size_t idx = 0;
 
     for (ucs4_t c = pInput[0]; c != char_nul; c = rest[0]) {
-        if (result->num_chars_visible >= map_size - 2) {
-            map_size = map_size * 2 + 1;
-            result->first_char = (size_t *) realloc(result->first_char, map_size * sizeof(size_t));
-            result->visible_char = (size_t *) realloc(result->visible_char, map_size * sizeof(size_t));
-        }
-
         if (!is_allowed_anywhere(c)) { /* currently used for config only, reconsider when using on input data */
             bx_fprintf(stderr, "%s: illegal character '%lc' (%#010x) encountered in string\n", PROJECT, c, (int) c);
-            bxs_free(result);
-            return NULL;
+            return -1;
         }
         else if (c == char_esc) {
             if (is_csi_reset(rest)) {
@@ -176,6 +221,24 @@ bxstr_t *bxs_from_unicode(uint32_t *pInput)
     result->visible_char[result->num_chars_visible] = idx;  // both point to the terminator
     result->first_char[result->num_chars_visible] = idx;
     result->trailing = non_blank_encountered ? blank_streak : 0;
+    return 0;
+}
+
+
+
+bxstr_t *bxs_from_unicode(uint32_t *pInput)
+{
+    if (pInput == NULL) {
+        bx_fprintf(stderr, "%s: internal error: bxs_from_unicode() called with NULL\n", PROJECT);
+        return NULL;
+    }
+
+    bxstr_t *result = (bxstr_t *) calloc(1, sizeof(bxstr_t));
+    result->memory = u32_strdup(pInput);
+    if (analyze_memory(result) != 0) {
+        bxs_free(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -279,6 +342,49 @@ bxstr_t *bxs_substr(bxstr_t *pString, size_t start_idx, size_t end_idx)
 
 
 
+int bxs_substr_inplace(bxstr_t *pString, size_t start_idx, size_t end_idx, size_t num_spaces)
+{
+    if (pString == NULL) {
+        return -1;
+    }
+    if (start_idx > pString->num_chars) {
+        start_idx = pString->num_chars;
+    }
+    if (end_idx > pString->num_chars) {
+        end_idx = pString->num_chars;
+    }
+    if (end_idx < start_idx) {
+        bx_fprintf(stderr, "%s: internal error: end_idx before start_idx in bxs_substr_inplace()\n", PROJECT);
+        return -1;
+    }
+
+    size_t len = end_idx - start_idx;
+    if (start_idx == num_spaces && len == pString->num_chars - start_idx) {
+        size_t i = 0;
+        while (i < num_spaces && pString->memory[i] == char_space) {
+            i++;
+        }
+        if (i == num_spaces) {
+            return 0;   /* nothing to do */
+        }
+    }
+    if (num_spaces + len > pString->num_chars) {
+        uint32_t *memory = (uint32_t *) realloc(pString->memory, (num_spaces + len + 1) * sizeof(uint32_t));
+        if (memory == NULL) {
+            return -1;
+        }
+        pString->memory = memory;
+    }
+    memmove(pString->memory + num_spaces, pString->memory + start_idx, len * sizeof(uint32_t));
+    for (size_t i = 0; i < num_spaces; i++) {
+        set_char_at(pString->memory, i, char_space);
+    }
+    set_char_at(pString->memory, num_spaces + len, char_nul);
+    return analyze_memory(pString);
+}
+
+
+
 bxstr_t *bxs_strcat(bxstr_t *pString, uint32_t *pToAppend)
 {
     if (pToAppend == NULL) {
@@ -469,6 +575,66 @@ bxstr_t *bxs_rtrim(bxstr_t *pString)
 
 
 
+size_t bxs_rtrim_raw(uint32_t *s, int visible_only)
+{
+    if (s == NULL) {
+        return 0;
+    }
+
+    /* This walks the string the same way as analyze_memory(), so that the result is identical to bxs_rtrim(). */
+    const uint32_t *rest = s;
+    size_t step_invis = 0;
+    size_t idx = 0;
+    size_t num_visible = 0;
+    int first_candidate = -1;
+    size_t blank_streak = 0;
+    int non_blank_encountered = 0;
+    size_t trim_idx = 0;                 /* where to cut if the current streak of blanks is trailing */
+    size_t trim_visible = 0;             /* number of visible characters before `trim_idx` */
+
+    for (ucs4_t c = s[0]; c != char_nul; c = rest[0]) {
+        if (c == char_esc) {
+            first_candidate = is_csi_reset(rest) ? -1 : (int) idx;
+        }
+        else {
+            if (is_blank(c)) {
+                if (blank_streak == 0) {
+                    trim_idx = first_candidate < 0 ? idx : (size_t) first_candidate;
+                    trim_visible = num_visible;
+                }
+                blank_streak++;
+            }
+            else {
+                blank_streak = 0;
+                non_blank_encountered = 1;
+            }
+            first_candidate = -1;
+        }
+
+        rest = advance_next32(rest, &step_invis);
+
+        if (step_invis == 0) {
+            if (visible_only) {
+                set_char_at(s, num_visible, s[idx]);  /* never overtakes `idx`, so nothing unread is overwritten */
+            }
+            num_visible++;
+            idx++;
+        }
+        else {
+            idx += step_invis;
+        }
+    }
+
+    size_t result_len = visible_only ? num_visible : (size_t) (rest - s);
+    if (non_blank_encountered && blank_streak > 0) {
+        result_len = visible_only ? trim_visible : trim_idx;
+    }
+    set_char_at(s, result_len, char_nul);
+    return result_len;
+}
+
+
+
 bxstr_t *bxs_prepend_spaces(bxstr_t *pString, size_t n)
 {
     bxstr_t *result = NULL;
@@ -122,6 +122,18 @@ bxstr_t *bxs_trimdup(bxstr_t *pString, size_t start_idx, size_t end_idx);
 bxstr_t *bxs_substr(bxstr_t *pString, size_t start_idx, size_t end_idx);
 
 
+/**
+ * Reduce the given string to one of its substrings, preceded by a number of spaces. This works in place, reusing the
+ * memory of the string.
+ * @param pString the string to modify
+ * @param start_idx the index of the first character (visible or invisible) of the substring, an index into `memory`
+ * @param end_idx the index of the first character (visible or invisible) following the substring
+ * @param num_spaces the number of spaces to put in front of the substring
+ * @return 0 on success, -1 on error, in which case the contents of `pString` are undefined
+ */
+int bxs_substr_inplace(bxstr_t *pString, size_t start_idx, size_t end_idx, size_t num_spaces);
+
+
 /**
  * Combine `pString + pToAppend` into a new string. Memory for the input strings is NOT modified or freed.
  * @param pString the string to append to
@@ -217,6 +229,17 @@ uint32_t *bxs_ltrim(bxstr_t *pString, size_t max);
 bxstr_t *bxs_rtrim(bxstr_t *pString);
 
 
+/**
+ * Remove all trailing whitespace from a string of raw codepoints, in place. The result is the same as with
+ * `bxs_rtrim()`, but no `bxstr_t` is created, and no memory is allocated.
+ * @param s the NUL-terminated string to trim, which will be modified
+ * @param visible_only flag indicating that invisible characters (escape sequences) should also be removed, as
+ *      `bxs_to_output()` does when colored output is not enabled
+ * @return the length of the resulting string in codepoints
+ */
+size_t bxs_rtrim_raw(uint32_t *s, int visible_only);
+
+
 /**
  * Prepend `n` spaces to the start of the given string. New memory is allocated for the result.
  * @param pString the original string (will not be modified, can be NULL, in which case spaces only in result)
@@ -92,6 +92,8 @@ void usage_long(FILE *st)
     fprintf(st, "      --color           Force output of ANSI sequences if present\n");
     fprintf(st, "      --no-color        Force monochrome output (no ANSI sequences)\n");
     fprintf(st, "  -d, --design <name>   Box design [default: first one in file]\n");
+    fprintf(st, "      --detect          Only report the box design detected in each infile\n");
+    fprintf(st, "      --edited <l1-l2>  With --region, only lines l1 to l2 of the box were changed since it was drawn\n");
     fprintf(st, "  -e, --eol <eol>       Override line break type (experimental) [default: %s]\n",
                                          strcmp(EOL_DEFAULT, "\r\n") == 0 ? "CRLF" : "LF");
     fprintf(st, "  -f, --config <file>   Configuration file [default: %s]\n",
@@ -102,14 +104,19 @@ void usage_long(FILE *st)
     fprintf(st, "      --kill-blank      Kill leading/trailing blank lines on removal (like -k true)\n");
     fprintf(st, "      --no-kill-blank   Retain leading/trailing blank lines on removal (like -k false)\n");
     fprintf(st, "  -l, --list            List available box designs w/ samples\n");
+    fprintf(st, "      --locate[=<fmt>]  Only report the position of each box, as tsv or json [default: tsv]\n");
+    fprintf(st, "      --measure[=<fmt>] Only report the size of the box for each design, as tsv or json [default: tsv]\n");
     fprintf(st, "  -m, --mend            Mend (repair) box\n");
     fprintf(st, "  -n, --encoding <enc>  Character encoding of input and output [default: %s]\n", locale_charset());
     fprintf(st, "  -p, --padding <fmt>   Padding [default: none]\n");
     fprintf(st, "  -q, --tag-query <qry> Query the list of designs by tag\n");
     fprintf(st, "  -r, --remove          Remove box\n");
-    fprintf(st, "  -s, --size <wxh>      Box size (width w and/or height h)\n");
+    fprintf(st, "      --remove-all      Remove all boxes, keeping the text between them\n");
+    fprintf(st, "      --region <l1-l2>  Process only input lines l1 to l2, pass the others through unchanged\n");
+    fprintf(st, "  -s, --size <wxh>      Box size (width w and/or height h), comma-separated for several boxes\n");
     fprintf(st, "  -t, --tabs <str>      Tab stop distance and expansion [default: %de]\n", DEF_TABSTOP);
     fprintf(st, "  -v, --version         Print version information\n");
+    fprintf(st, "      --work-limit <n>  Maximum number of steps for detection and removal [default: no limit]\n");
     /* fprintf(st, "  -x, --extra <arg>     If <arg> starts with "debug:", activate debug logging for specified log
                 areas which follow in a comma-separated list [default area: MAIN]. If <arg> is "(undoc)", trigger
                 undocumented behavior of design detail lister.");  // undocumented */
@@ -300,6 +307,52 @@ static int eol_override(opt_t *result, char *optarg)
 
 
 
+/**
+ * Output format of the box locator.
+ * @param result the options struct we are building
+ * @param optarg the optional argument to `--locate` on the command line, may be NULL
+ * @returns 0 on success, anything else on error
+ */
+static int locate_format(opt_t *result, char *optarg)
+{
+    if (optarg == NULL || strcasecmp(optarg, "tsv") == 0) {
+        result->locate = 't';
+    }
+    else if (strcasecmp(optarg, "json") == 0) {
+        result->locate = 'j';
+    }
+    else {
+        bx_fprintf(stderr, "%s: invalid locate format -- %s\n", PROJECT, optarg);
+        return 1;
+    }
+    return 0;
+}
+
+
+
+/**
+ * Output format of the box measurement.
+ * @param result the options struct we are building
+ * @param optarg the optional argument to `--measure` on the command line, may be NULL
+ * @returns 0 on success, anything else on error
+ */
+static int measure_format(opt_t *result, char *optarg)
+{
+    if (optarg == NULL || strcasecmp(optarg, "tsv") == 0) {
+        result->measure = 't';
+    }
+    else if (strcasecmp(optarg, "json") == 0) {
+        result->measure = 'j';
+    }
+    else {
+        bx_fprintf(stderr, "%s: invalid measure format -- %s\n", PROJECT, optarg);
+        return 1;
+    }
+    return 0;
+}
+
+
+
 /**
  * Indentation mode.
  * @param result the options struct we are building
@@ -436,30 +489,116 @@ static int query(opt_t *result, char *optarg)
 
 
 /**
- * Specify desired box target size.
+ * Parse a range of input lines, given as two line numbers separated by a dash.
+ * @param optarg the argument from the command line
+ * @param out_first pointer to a memory location where the number of the first line is stored (1-based)
+ * @param out_last pointer to a memory location where the number of the last line is stored (1-based)
+ * @returns 0 on success, anything else on error
+ */
+static int line_range(char *optarg, size_t *out_first, size_t *out_last)
+{
+    char *p = NULL;
+    errno = 0;
+    long first = strtol(optarg, &p, 10);
+    long last = 0;
+    int valid = errno == 0 && p != optarg && *p == '-';
+    if (valid) {
+        char *q = NULL;
+        last = strtol(p + 1, &q, 10);
+        valid = errno == 0 && q != p + 1 && *q == '\0' && first >= 1 && last >= first;
+    }
+    if (!valid) {
+        return 1;
+    }
+    *out_first = (size_t) first;
+    *out_last = (size_t) last;
+    return 0;
+}
+
+
+
+/**
+ * Restrict processing to a range of input lines.
  * @param result the options struct we are building
- * @param optarg the argument to `-s` on the command line
+ * @param optarg the argument to `--region` on the command line, which is two line numbers separated by a dash
  * @returns 0 on success, anything else on error
  */
-static int size_of_box(opt_t *result, char *optarg)
+static int region(opt_t *result, char *optarg)
 {
-    char *p = strchr(optarg, 'x');
+    if (line_range(optarg, &(result->region_first), &(result->region_last)) != 0) {
+        bx_fprintf(stderr, "%s: invalid region specification -- %s\n", PROJECT, optarg);
+        return 1;
+    }
+    return 0;
+}
+
+
+
+/**
+ * Specify the range of lines which were edited since the box in the region was last drawn.
+ * @param result the options struct we are building
+ * @param optarg the argument to `--edited` on the command line, which is two line numbers separated by a dash
+ * @returns 0 on success, anything else on error
+ */
+static int edited(opt_t *result, char *optarg)
+{
+    if (line_range(optarg, &(result->edited_first), &(result->edited_last)) != 0) {
+        bx_fprintf(stderr, "%s: invalid edited lines specification -- %s\n", PROJECT, optarg);
+        return 1;
+    }
+    return 0;
+}
+
+
+
+/**
+ * Limit the work spent on design detection and box removal.
+ * @param result the options struct we are building
+ * @param optarg the argument to `--work-limit` on the command line, which is a positive number of steps
+ * @returns 0 on success, anything else on error
+ */
+static int work_limit(opt_t *result, char *optarg)
+{
+    char *p = NULL;
+    errno = 0;
+    long steps = strtol(optarg, &p, 10);
+    if (errno != 0 || p == optarg || *p != '\0' || steps < 1) {
+        bx_fprintf(stderr, "%s: invalid work limit -- %s\n", PROJECT, optarg);
+        return 1;
+    }
+    result->work_limit = (size_t) steps;
+    return 0;
+}
+
+
+
+/**
+ * Parse a single box size specification of the form `wxh`, `w`, or `xh`.
+ * @param spec the size specification, which is temporarily modified during parsing
+ * @param width (OUT) the requested box width, or 0 if not specified
+ * @param height (OUT) the requested box height, or 0 if not specified
+ * @return 0 on success, 1 if the specification is invalid
+ */
+static int parse_box_size(char *spec, long *width, long *height)
+{
+    char *p = strchr(spec, 'x');
     if (!p) {
-        p = strchr(optarg, 'X');
+        p = strchr(spec, 'X');
     }
     if (p) {
         *p = '\0';
     }
     errno = 0;
-    if (optarg != p) {
-        result->reqwidth = strtol(optarg, NULL, 10);
+    *width = 0;
+    *height = 0;
+    if (spec != p) {
+        *width = strtol(spec, NULL, 10);
     }
     if (p) {
-        result->reqheight = strtol(p + 1, NULL, 10);
+        *height = strtol(p + 1, NULL, 10);
         *p = 'x';
     }
-    if (errno || (result->reqwidth == 0 && result->reqheight == 0) || result->reqwidth < 0 || result->reqheight < 0) {
-        bx_fprintf(stderr, "%s: invalid box size specification -- %s\n", PROJECT, optarg);
+    if (errno || (*width == 0 && *height == 0) || *width < 0 || *height < 0) {
         return 1;
     }
     return 0;
@@ -467,6 +606,57 @@ static int size_of_box(opt_t *result, char *optarg)
 
 
 
+/**
+ * Specify desired box target size. Several sizes may be given as a comma-separated list, in which case one box is
+ * drawn for each of them. The first size is also stored in `reqwidth` and `reqheight`.
+ * @param result the options struct we are building
+ * @param optarg the argument to `-s` on the command line
+ * @returns 0 on success, anything else on error
+ */
+static int size_of_box(opt_t *result, char *optarg)
+{
+    size_t num_sizes = 1;
+    for (char *c = optarg; *c != '\0'; ++c) {
+        if (*c == ',') {
+            num_sizes++;
+        }
+    }
+    BFREE(result->reqwidths);
+    BFREE(result->reqheights);
+    result->reqwidths = (long *) calloc(num_sizes, sizeof(long));
+    result->reqheights = (long *) calloc(num_sizes, sizeof(long));
+    if (result->reqwidths == NULL || result->reqheights == NULL) {
+        perror(PROJECT);
+        return 1;
+    }
+    result->num_sizes = num_sizes;
+
+    char *spec = optarg;
+    for (size_t i = 0; i < num_sizes; ++i) {
+        char *next = strchr(spec, ',');
+        if (next != NULL) {
+            *next = '\0';
+        }
+        int invalid = parse_box_size(spec, result->reqwidths + i, result->reqheights + i);
+        if (next != NULL) {
+            *next = ',';
+        }
+        if (invalid) {
+            bx_fprintf(stderr, "%s: invalid box size specification -- %s\n", PROJECT, optarg);
+            return 1;
+        }
+        if (next != NULL) {
+            spec = next + 1;
+        }
+    }
+
+    result->reqwidth = result->reqwidths[0];
+    result->reqheight = result->reqheights[0];
+    return 0;
+}
+
+
+
 static int debug_areas(opt_t *result, char *optarg)
 {
     char *dup = NULL;
@@ -628,6 +818,7 @@ static FILE *get_stdout_configured(opt_t *result)
 /**
  * Input and Output Files. After any command line options, an input file and an output file may be specified (in that
  * order). "-" may be substituted for standard input or output. A third file name would be invalid.
+ * In `--detect` and `--locate` mode, there is no output file, and any number of input files may be given instead.
  * @param result the options struct we are building
  * @param argv the original command line options as specified
  * @param optind the index of the next element to be processed in `argv`
@@ -635,7 +826,13 @@ static FILE *get_stdout_configured(opt_t *result)
  */
 static int input_output_files(opt_t *result, char *argv[], int optind)
 {
-    if (argv[optind] == NULL) {                              /* neither infile nor outfile given */
+    if ((result->detect || result->locate) && argv[optind] != NULL) {  /* list of infiles, opened one by one later */
+        result->infiles = argv + optind;
+        result->infile = stdin;
+        result->outfile = get_stdout_configured(result);
+    }
+
+    else if (argv[optind] == NULL) {                         /* neither infile nor outfile given */
         result->infile = stdin;
         result->outfile = get_stdout_configured(result);
     }
@@ -688,6 +885,7 @@ static void print_debug_info(opt_t *result)
                 result->halign ? result->halign : '?', result->valign ? result->valign : '?');
         log_debug(__FILE__, MAIN, "  - Line justification (-a): \'%c\'\n", result->justify ? result->justify : '?');
         log_debug(__FILE__, MAIN, "  - Design Definition W shape (-c): %s\n", result->cld ? result->cld : "n/a");
+        log_debug(__FILE__, MAIN, "  - Detect design only (--detect): %d\n", result->detect);
         log_debug(__FILE__, MAIN, "  - Color mode: %d\n", result->color);
 
         log_debug(__FILE__, MAIN, "  - Debug areas (-x debug:...): ");
@@ -705,6 +903,8 @@ static void print_debug_info(opt_t *result)
         log_debug(__FILE__, MAIN, "  - Explicit config file (-f): %s\n", result->f ? result->f : "no");
         log_debug(__FILE__, MAIN, "  - Indentmode (-i): \'%c\'\n", result->indentmode ? result->indentmode : '?');
         log_debug(__FILE__, MAIN, "  - Kill blank lines (-k): %d\n", result->killblank);
+        log_debug(__FILE__, MAIN, "  - Locate boxes (--locate): \'%c\'\n", result->locate ? result->locate : '?');
+        log_debug(__FILE__, MAIN, "  - Measure boxes (--measure): \'%c\'\n", result->measure ? result->measure : '?');
         log_debug(__FILE__, MAIN, "  - Mend box (-m): %d\n", result->mend);
         log_debug(__FILE__, MAIN, "  - Padding (-p): l:%d t:%d r:%d b:%d\n",
                 result->padding[BLEF], result->padding[BTOP], result->padding[BRIG], result->padding[BBOT]);
@@ -721,9 +921,23 @@ static void print_debug_info(opt_t *result)
 
         log_debug(__FILE__, MAIN, "  - qundoc (-x): %d\n", result->qundoc);
         log_debug(__FILE__, MAIN, "  - Remove box (-r): %d\n", result->r);
-        log_debug(__FILE__, MAIN, "  - Requested box size (-s): %ldx%ld\n", result->reqwidth, result->reqheight);
+        log_debug(__FILE__, MAIN, "  - Region (--region): %d-%d\n", (int) result->region_first,
+                (int) result->region_last);
+        log_debug(__FILE__, MAIN, "  - Edited lines (--edited): %d-%d\n", (int) result->edited_first,
+                (int) result->edited_last);
+        log_debug(__FILE__, MAIN, "  - Remove all boxes (--remove-all): %d\n", result->remove_all);
+        log_debug(__FILE__, MAIN, "  - Requested box size (-s): ");
+        if (result->num_sizes > 0) {
+            for (size_t i = 0; i < result->num_sizes; ++i) {
+                log_debug_cont(MAIN, "%s%ldx%ld", i > 0 ? ", " : "", result->reqwidths[i], result->reqheights[i]);
+            }
+        } else {
+            log_debug_cont(MAIN, "(none)");
+        }
+        log_debug_cont(MAIN, "\n");
         log_debug(__FILE__, MAIN, "  - Tabstop distance (-t): %d\n", result->tabstop);
         log_debug(__FILE__, MAIN, "  - Tab handling (-t): \'%c\'\n", result->tabexp);
+        log_debug(__FILE__, MAIN, "  - Work limit (--work-limit): %d\n", (int) result->work_limit);
     }
 }
 
@@ -755,6 +969,8 @@ opt_t *process_commandline(int argc, char *argv[])
         { "color",         no_argument,       NULL, OPT_COLOR },
         { "no-color",      no_argument,       NULL, OPT_NO_COLOR },
         { "design",        required_argument, NULL, 'd' },
+        { "detect",        no_argument,       NULL, OPT_DETECT },
+        { "edited",        required_argument, NULL, OPT_EDITED },
         { "eol",           required_argument, NULL, 'e' },
         { "config",        required_argument, NULL, 'f' },
         { "help",          no_argument,       NULL, 'h' },
@@ -762,14 +978,19 @@ opt_t *process_commandline(int argc, char *argv[])
         { "kill-blank",    no_argument,       NULL, OPT_KILLBLANK },
         { "no-kill-blank", no_argument,       NULL, OPT_NO_KILLBLANK },
         { "list",          no_argument,       NULL, 'l' },
+        { "locate",        optional_argument, NULL, OPT_LOCATE },
+        { "measure",       optional_argument, NULL, OPT_MEASURE },
         { "mend",          no_argument,       NULL, 'm' },
         { "encoding",      required_argument, NULL, 'n' },
         { "padding",       required_argument, NULL, 'p' },
         { "tag-query",     required_argument, NULL, 'q' },
         { "remove",        no_argument,       NULL, 'r' },
+        { "region",        required_argument, NULL, OPT_REGION },
+        { "remove-all",    no_argument,       NULL, OPT_REMOVE_ALL },
         { "size",          required_argument, NULL, 's' },
         { "tabs",          required_argument, NULL, 't' },
         { "version",       no_argument,       NULL, 'v' },
+        { "work-limit",    required_argument, NULL, OPT_WORK_LIMIT },
         { "extra",         required_argument, NULL, 'x' },
         { NULL,            0,                 NULL,  0  }
     };
@@ -810,6 +1031,11 @@ opt_t *process_commandline(int argc, char *argv[])
                 }
                 break;
 
+            case OPT_DETECT:
+                result->detect = 1;   /* detect design only, input is read like for removal */
+                result->r = 1;
+                break;
+
             case 'e':
                 if (eol_override(result, optarg) != 0) {
                     BFREE(result);
@@ -855,8 +1081,23 @@ opt_t *process_commandline(int argc, char *argv[])
                 result->l = 1;   /* list available box styles */
                 break;
 
+            case OPT_LOCATE:
+                if (locate_format(result, optarg) != 0) {
+                    BFREE(result);
+                    return NULL;
+                }
+                result->r = 1;   /* input is read like for removal */
+                break;
+
+            case OPT_MEASURE:
+                if (measure_format(result, optarg) != 0) {
+                    BFREE(result);
+                    return NULL;
+                }
+                break;
+
             case 'm':
-                result->mend = 2;   /*  Mend box: remove, then redraw */
+                result->mend = 1;   /*  Mend box: remove, then redraw */
                 result->r = 1;
                 result->killblank = 0;
                 break;
@@ -888,6 +1129,25 @@ opt_t *process_commandline(int argc, char *argv[])
                 result->r = 1;   /* remove box */
                 break;
 
+            case OPT_EDITED:
+                if (edited(result, optarg) != 0) {
+                    BFREE(result);
+                    return NULL;
+                }
+                break;
+
+            case OPT_REGION:
+                if (region(result, optarg) != 0) {
+                    BFREE(result);
+                    return NULL;
+                }
+                break;
+
+            case OPT_REMOVE_ALL:
+                result->remove_all = 1;   /* remove all boxes */
+                result->r = 1;
+                break;
+
             case 's':
                 if (size_of_box(result, optarg) != 0) {
                     BFREE(result);
@@ -906,6 +1166,13 @@ opt_t *process_commandline(int argc, char *argv[])
                 result->version_requested = 1;   /* print version number */
                 return result;
 
+            case OPT_WORK_LIMIT:
+                if (work_limit(result, optarg) != 0) {
+                    BFREE(result);
+                    return NULL;
+                }
+                break;
+
             case 'x':
                 if (undocumented_options(result, optarg) != 0) {
                     BFREE(result);
@@ -931,6 +1198,59 @@ opt_t *process_commandline(int argc, char *argv[])
         }
     } while (oc != EOF);
 
+    if (result->detect && result->design_choice_by_user) {
+        bx_fprintf(stderr, "%s: --detect cannot be combined with -c or -d\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
+    if (result->locate && (result->detect || result->remove_all || result->mend)) {
+        bx_fprintf(stderr, "%s: --locate cannot be combined with --detect, --remove-all, or -m\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
+    if (result->region_first > 0 && (result->detect || result->locate)) {
+        bx_fprintf(stderr, "%s: --region cannot be combined with --detect or --locate\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
+    if (result->region_first > 0 && result->num_sizes > 1) {
+        bx_fprintf(stderr, "%s: --region cannot be combined with more than one box size\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
+    if (result->edited_first > 0 && (result->region_first == 0 || !result->r || !result->design_choice_by_user
+            || result->remove_all || result->edited_first < result->region_first
+            || result->edited_last > result->region_last))
+    {
+        bx_fprintf(stderr, "%s: --edited requires --region around the edited lines, -d, and -r or -m\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
+    if (result->measure && (result->r || result->region_first > 0)) {
+        bx_fprintf(stderr, "%s: --measure cannot be combined with -r, -m, --detect, --locate, --remove-all, "
+                "or --region\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
+    if (result->remove_all && result->mend) {
+        bx_fprintf(stderr, "%s: --remove-all cannot be combined with -m\n", PROJECT);
+        usage_short(stderr);
+        BFREE(result);
+        return NULL;
+    }
+
     if (input_output_files(result, argv, optind) != 0) {
         BFREE(result);
         return NULL;
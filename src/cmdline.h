@@ -33,6 +33,13 @@
 #define OPT_NO_COLOR 1002
 #define OPT_KILLBLANK 1003
 #define OPT_NO_KILLBLANK 1004
+#define OPT_DETECT 1005
+#define OPT_REMOVE_ALL 1006
+#define OPT_LOCATE 1007
+#define OPT_REGION 1008
+#define OPT_WORK_LIMIT 1009
+#define OPT_MEASURE 1010
+#define OPT_EDITED 1011
 
 
 /**
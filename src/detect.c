@@ -40,6 +40,11 @@
 
 #include "config.h"
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <unistr.h>
 #include <unitypes.h>
 
@@ -53,6 +58,19 @@
 
 
 
+/** number of evenly spaced body lines examined per design when detection samples the input */
+#define SAMPLE_BODY_LINES 32
+
+/** minimum number of input lines for sampling to be used at all; smaller inputs are always scanned in full */
+#define SAMPLE_MIN_INPUT_LINES (4 * SAMPLE_BODY_LINES)
+
+/** name of the environment variable which may point to the file used for caching design autodetection results */
+#define DETECT_CACHE_ENV "BOXES_DETECT_CACHE"
+
+/** maximum number of entries kept in the autodetection cache file; the oldest entries are dropped first */
+#define DETECT_CACHE_MAX_ENTRIES 1000
+
+
 char *comparison_name[] = {
         "literal", "ignore_invisible_input", "ignore_invisible_shape", "ignore_invisible_all"
 };
@@ -61,15 +79,8 @@ char *comparison_name[] = {
 
 int input_is_mono()
 {
-    int result = 1;
-    for (size_t line_no = 0; line_no < input.num_lines; line_no++) {
-        if (input.lines[line_no].text->num_chars_invisible > 0) {
-            result = 0;
-            break;
-        }
-    }
-    log_debug(__FILE__, MAIN, "Input is %s\n", result ? "mono" : "potentially colored");
-    return result;
+    log_debug(__FILE__, MAIN, "Input is %s\n", input.mono ? "mono" : "potentially colored");
+    return input.mono;
 }
 
 
@@ -109,6 +120,38 @@ int comp_type_is_viable(comparison_t comp_type, int mono_input, int mono_design)
 
 
 
+comparison_t effective_comp_type(comparison_t comp_type, int mono_line, int mono_shapes)
+{
+    int ignore_input = (comp_type == ignore_invisible_input || comp_type == ignore_invisible_all) && !mono_line;
+    int ignore_shape = (comp_type == ignore_invisible_shape || comp_type == ignore_invisible_all) && !mono_shapes;
+    if (ignore_input && ignore_shape) {
+        return ignore_invisible_all;
+    }
+    else if (ignore_input) {
+        return ignore_invisible_input;
+    }
+    else if (ignore_shape) {
+        return ignore_invisible_shape;
+    }
+    return literal;
+}
+
+
+
+void spend_work(size_t steps)
+{
+    input.work_spent += steps;
+}
+
+
+
+int work_limit_exceeded(size_t pending_steps)
+{
+    return opt.work_limit > 0 && input.work_spent + pending_steps > opt.work_limit;
+}
+
+
+
 static int *determine_empty_sides(design_t *current_design)
 {
     int *result = (int *) calloc(NUM_SIDES, sizeof(int));
@@ -127,10 +170,7 @@ static uint32_t *get_visible_text(line_t *line)
 {
     uint32_t *result = NULL;
     if (line != NULL) {
-        if (line->cache_visible == NULL) {
-            line->cache_visible = bxs_filter_visible(line->text);
-        }
-        result = line->cache_visible;
+        result = line->mono ? line->text->memory : input.visible + line->visible_idx;
     }
     return result;
 }
@@ -245,6 +285,35 @@ uint32_t *prepare_comp_input(size_t input_line_idx, int trim_left, comparison_t
 
 
 
+/**
+ * Determine the next body line to check for vertical shapes. In a full scan, this is simply the next line. When
+ * sampling, only the first and last `maxshapeheight` lines of the body are checked in full, plus about
+ * `SAMPLE_BODY_LINES` evenly spaced lines in between. Thus, the cost of detection no longer depends on input size.
+ * @param current_design the current design to check
+ * @param k the body line which was just checked
+ * @param body_start index of the first body line
+ * @param body_end index of the first line after the body
+ * @param sampled flag indicating that only a sample of the body lines should be checked
+ * @return the index of the next line to check, `>= body_end` when done
+ */
+static size_t next_body_line(design_t *current_design, size_t k, size_t body_start, size_t body_end, int sampled)
+{
+    size_t edge = current_design->maxshapeheight;
+    ++k;
+    if (!sampled || body_end - body_start <= 2 * edge + SAMPLE_BODY_LINES
+            || k < body_start + edge || k >= body_end - edge)
+    {
+        return k;
+    }
+
+    size_t middle_start = body_start + edge;
+    size_t stride = (body_end - edge - middle_start) / SAMPLE_BODY_LINES;
+    size_t result = middle_start + ((k - middle_start + stride - 1) / stride) * stride;
+    return BMIN(result, body_end - edge);
+}
+
+
+
 /**
  * Try and find west corner shapes. Every non-empty shape line is searched for on every input line. A hit is generated
  * whenever a match is found.
@@ -280,6 +349,7 @@ static size_t find_west_corner(design_t *current_design, comparison_t comp_type,
             }
 
             uint32_t *input_relevant = prepare_comp_input(a, 1, comp_type, 0, NULL, NULL);
+            spend_work(1);
             if (u32_strncmp(input_relevant, shape_relevant, length_relevant) == 0) {
                 ++hits; /* CHECK more hit points for longer matches, or simple boxes might match too easily */
             }
@@ -329,6 +399,7 @@ static size_t find_east_corner(design_t *current_design, comparison_t comp_type,
             }
 
             uint32_t *input_relevant = prepare_comp_input(a, 0, comp_type, length_relevant, NULL, NULL);
+            spend_work(1);
             if (input_relevant && (u32_strncmp(input_relevant, shape_relevant, length_relevant) == 0)) {
                 ++hits; /* CHECK more hit points for longer matches, or simple boxes might match too easily */
             }
@@ -381,11 +452,13 @@ static size_t find_horizontal_shape(design_t *current_design, comparison_t comp_
             }
 
             uint32_t *input_relevant = prepare_comp_input(line_idx, 1, comp_type, 0, NULL, NULL);
-            uint32_t *p = u32_strstr(input_relevant, shape_relevant);
+            size_t input_length = u32_strlen(input_relevant);
+            spend_work(1);
+            uint32_t *p = u32_find_first(input_relevant, input_length, shape_relevant, length_relevant);
             if (p) {
                 if (current_design->shape[hshape].elastic) {
                     p += length_relevant;
-                    if (p - input_relevant >= (long) u32_strlen(input_relevant)) {
+                    if (p - input_relevant >= (long) input_length) {
                         continue;
                     }
                     if (u32_strncmp(p, shape_relevant, length_relevant) == 0) {
@@ -413,9 +486,12 @@ static size_t find_horizontal_shape(design_t *current_design, comparison_t comp_
  * @param comp_type the comparison type (how to compare colored strings)
  * @param empty information on which box sides are empty in that design
  * @param vshape which vertical shape to search for
+ * @param uncertain NULL for a full scan. Otherwise, only a sample of the body lines is checked, and the number of hits
+ *          which could only be estimated is added to the memory location pointed to.
  * @return the number of hits for this vertical shape
  */
-static size_t find_vertical_west(design_t *current_design, comparison_t comp_type, int *empty, shape_t vshape)
+static size_t find_vertical_west(design_t *current_design, comparison_t comp_type, int *empty, shape_t vshape,
+        size_t *uncertain)
 {
     size_t hits = 0;
     if (((empty[BTOP] ? 0 : current_design->shape[NW].height) + (empty[BBOT] ? 0 : current_design->shape[SW].height))
@@ -426,10 +502,14 @@ static size_t find_vertical_west(design_t *current_design, comparison_t comp_typ
         /* no hits */
     }
     else {
-        for (size_t k = empty[BTOP] ? 0 : current_design->shape[NW].height;
-                k < input.num_lines - (empty[BBOT] ? 0 : current_design->shape[SW].height); ++k)
+        size_t body_start = empty[BTOP] ? 0 : current_design->shape[NW].height;
+        size_t body_end = input.num_lines - (empty[BBOT] ? 0 : current_design->shape[SW].height);
+        size_t lines_checked = 0;
+        for (size_t k = body_start; k < body_end;
+                k = next_body_line(current_design, k, body_start, body_end, uncertain != NULL))
         {
             uint32_t *input_relevant = prepare_comp_input(k, 1, comp_type, 0, NULL, NULL);
+            ++lines_checked;
 
             for (size_t j = 0; j < current_design->shape[vshape].height; ++j) {
                 bxstr_t *shape_line = current_design->shape[vshape].mbcs[j];
@@ -440,13 +520,23 @@ static size_t find_vertical_west(design_t *current_design, comparison_t comp_typ
                 uint32_t *shape_relevant = prepare_comp_shape(current_design, vshape, j, comp_type, 1, 0);
                 size_t length_relevant = u32_strlen(shape_relevant);
 
-                if (u32_strncmp(input_relevant, shape_relevant, length_relevant) == 0) {
+                spend_work(1);
+                int matched = u32_strncmp(input_relevant, shape_relevant, length_relevant) == 0;
+                BFREE(shape_relevant);
+                if (matched) {
                     ++hits;
                     break;
                 }
-                BFREE(shape_relevant);
             }
         }
+        if (lines_checked < body_end - body_start) {
+            /* extrapolate, so that sampled scores remain comparable to the corner and horizontal shape hits */
+            size_t estimate = (hits * (body_end - body_start) + lines_checked / 2) / lines_checked;
+            if (hits > 0 && hits < lines_checked) {
+                *uncertain += estimate - hits;   /* the shape matched only some of the lines */
+            }
+            hits = estimate;
+        }
     }
 
     log_debug(__FILE__, MAIN, "Checking %-3s shape produced %d hits.\n", shape_name[vshape], (int) hits);
@@ -462,9 +552,12 @@ static size_t find_vertical_west(design_t *current_design, comparison_t comp_typ
  * @param comp_type the comparison type (how to compare colored strings)
  * @param empty information on which box sides are empty in that design
  * @param vshape which vertical shape to search for
+ * @param uncertain NULL for a full scan. Otherwise, only a sample of the body lines is checked, and the number of hits
+ *          which could only be estimated is added to the memory location pointed to.
  * @return the number of hits for this vertical shape
  */
-static size_t find_vertical_east(design_t *current_design, comparison_t comp_type, int *empty, shape_t vshape)
+static size_t find_vertical_east(design_t *current_design, comparison_t comp_type, int *empty, shape_t vshape,
+        size_t *uncertain)
 {
     size_t hits = 0;
     if (((empty[BTOP] ? 0 : current_design->shape[NW].height) + (empty[BBOT] ? 0 : current_design->shape[SW].height))
@@ -475,6 +568,8 @@ static size_t find_vertical_east(design_t *current_design, comparison_t comp_typ
         /* no hits */
     }
     else {
+        size_t body_start = empty[BTOP] ? 0 : current_design->shape[NW].height;
+        size_t body_end = input.num_lines - (empty[BBOT] ? 0 : current_design->shape[SW].height);
         for (size_t j = 0; j < current_design->shape[vshape].height; ++j) {
             bxstr_t *shape_line = current_design->shape[vshape].mbcs[j];
             if (bxs_is_blank(shape_line)) {
@@ -484,15 +579,23 @@ static size_t find_vertical_east(design_t *current_design, comparison_t comp_typ
             uint32_t *shape_relevant = prepare_comp_shape(current_design, vshape, j, comp_type, 1, 1);
             size_t length_relevant = u32_strlen(shape_relevant);
 
-            for (size_t k = empty[BTOP] ? 0 : current_design->shape[NW].height;
-                    k < input.num_lines - (empty[BBOT] ? 0 : current_design->shape[SW].height); ++k)
+            size_t lines_checked = 0;
+            int found = 0;
+            for (size_t k = body_start; k < body_end;
+                    k = next_body_line(current_design, k, body_start, body_end, uncertain != NULL))
             {
                 uint32_t *input_relevant = prepare_comp_input(k, 0, comp_type, length_relevant, NULL, NULL);
+                ++lines_checked;
+                spend_work(1);
                 if (input_relevant != NULL && u32_strncmp(input_relevant, shape_relevant, length_relevant) == 0) {
                     ++hits;
+                    found = 1;
                     break;
                 }
             }
+            if (!found && lines_checked < body_end - body_start) {
+                ++(*uncertain);   /* the shape line might still occur on one of the lines we skipped */
+            }
             BFREE(shape_relevant);
         }
     }
@@ -503,10 +606,21 @@ static size_t find_vertical_east(design_t *current_design, comparison_t comp_typ
 
 
 
-static long match_design(design_t *current_design, comparison_t comp_type)
+/**
+ * Compute the score of a design, which is the total number of hits of all its shapes.
+ * @param current_design the current design to check
+ * @param comp_type the comparison type (how to compare colored strings)
+ * @param uncertain NULL for a full scan. Otherwise, only a sample of the body lines is checked, and the number of hits
+ *          which could only be estimated is stored in the memory location pointed to.
+ * @return the score
+ */
+static long match_design(design_t *current_design, comparison_t comp_type, size_t *uncertain)
 {
     int *empty = determine_empty_sides(current_design);
     long hits = 0;
+    if (uncertain != NULL) {
+        *uncertain = 0;
+    }
 
     for (shape_t scnt = 0; scnt < NUM_SHAPES; ++scnt) {
         switch (scnt) {
@@ -526,11 +640,11 @@ static long match_design(design_t *current_design, comparison_t comp_type)
                 break;
 
             case ENE: case E: case ESE:
-                hits += find_vertical_east(current_design, comp_type, empty, scnt);
+                hits += find_vertical_east(current_design, comp_type, empty, scnt, uncertain);
                 break;
 
             case WSW: case W: case WNW:
-                hits += find_vertical_west(current_design, comp_type, empty, scnt);
+                hits += find_vertical_west(current_design, comp_type, empty, scnt, uncertain);
                 break;
 
             default:
@@ -545,18 +659,47 @@ static long match_design(design_t *current_design, comparison_t comp_type)
 
 
 
-design_t *autodetect_design()
+static int design_frames_input(design_t *design, comparison_t comp_type);
+
+
+
+/**
+ * Score all designs against the input and pick the one with the most hits. When two designs score the same, the one
+ * which matches the whole frame of the box wins; if both or neither do, the one defined first wins.
+ * @param mono_input flag indicating that there are no invisible characters in the input
+ * @param sampled flag indicating that only a sample of the body lines should be checked
+ * @param out_ambiguous pointer to a memory location where it is stored whether a full scan might come to a different
+ *          conclusion, because the estimated hits could make up for the lead of the winner (or nothing was found)
+ * @param out_scores array of `num_designs` elements which receives the best score of each design, may be NULL
+ * @param out_hits pointer to a memory location where the score of the winner is stored
+ * @param out_runner_up pointer to a memory location where the best score of any other design is stored
+ * @return pointer to the design with the most hits, or NULL if no design scored any hits
+ */
+static design_t *score_designs(int mono_input, int sampled, int *out_ambiguous, long *out_scores, long *out_hits,
+        long *out_runner_up)
 {
     design_t *current_design;           /* ptr to currently tested design */
     long maxhits = 0;                   /* maximum no. of hits so far */
+    size_t max_uncertain = 0;           /* number of estimated hits among `maxhits` */
+    long runner_up = 0;                 /* maximum no. of hits of any design other than `result` */
+    size_t runner_up_uncertain = 0;     /* number of estimated hits among `runner_up` */
     design_t *result = NULL;            /* ptr to design with the most hits */
-    int mono_input = input_is_mono();
-    (void) comparison_name;             /* used only in debug statements */
+    comparison_t result_comp = literal; /* comparison type which gave `result` its hits */
+    int result_frames = -1;             /* whether `result` matches the whole frame; -1 if not checked yet */
+
+    if (out_scores != NULL) {
+        memset(out_scores, 0, num_designs * sizeof(long));
+    }
+
+    int *mono_designs = (int *) calloc(num_designs, sizeof(int));
+    for (size_t dcnt = 0; ((int) dcnt) < num_designs; ++dcnt) {
+        mono_designs[dcnt] = design_is_mono(designs + dcnt);
+    }
 
     for (comparison_t comp_type = 0; comp_type < NUM_COMPARISON_TYPES; comp_type++) {
         current_design = designs;
         for (size_t dcnt = 0; ((int) dcnt) < num_designs; ++dcnt, ++current_design) {
-            int mono_design = design_is_mono(current_design);
+            int mono_design = mono_designs[dcnt];
             if (!comp_type_is_viable(comp_type, mono_input, mono_design)) {
                 log_debug(__FILE__, MAIN, "Design \"%s\" skipped for comparison type '%s' because mono_input=%d and "
                         "mono_design=%d\n", current_design->name, comparison_name[comp_type], mono_input, mono_design);
@@ -566,21 +709,71 @@ design_t *autodetect_design()
             log_debug(__FILE__, MAIN, "CONSIDERING DESIGN ---- \"%s\" ---------------\n", current_design->name);
             log_debug(__FILE__, MAIN, "    comparison_type = %s\n", comparison_name[comp_type]);
 
-            long hits = match_design(current_design, comp_type);
-            log_debug(__FILE__, MAIN, "Design \"%s\" scored %ld points\n", current_design->name, hits);
+            size_t uncertain = 0;
+            long hits = match_design(current_design, comp_type, sampled ? &uncertain : NULL);
+            log_debug(__FILE__, MAIN, "Design \"%s\" scored %ld points (%d estimated)\n", current_design->name, hits,
+                    (int) uncertain);
+            if (out_scores != NULL && hits > out_scores[dcnt]) {
+                out_scores[dcnt] = hits;
+            }
             if (hits > maxhits) {
+                if (current_design != result) {
+                    runner_up = maxhits;
+                    runner_up_uncertain = max_uncertain;
+                }
                 maxhits = hits;
+                max_uncertain = uncertain;
                 result = current_design;
+                result_comp = comp_type;
+                result_frames = -1;
+            }
+            else if (hits == maxhits && hits > 2 && current_design != result) {
+                if (result_frames < 0) {
+                    result_frames = design_frames_input(result, result_comp);
+                }
+                if (!result_frames && design_frames_input(current_design, comp_type)) {
+                    log_debug(__FILE__, MAIN, "Design \"%s\" wins the tie with \"%s\" by matching the whole frame\n",
+                            current_design->name, result->name);
+                    runner_up = maxhits;
+                    runner_up_uncertain = max_uncertain;
+                    max_uncertain = uncertain;
+                    result = current_design;
+                    result_comp = comp_type;
+                    result_frames = 1;
+                }
+                else if (hits + (long) uncertain >= runner_up + (long) runner_up_uncertain) {
+                    runner_up = hits;
+                    runner_up_uncertain = uncertain;
+                }
+            }
+            else if (current_design != result && hits + (long) uncertain >= runner_up + (long) runner_up_uncertain) {
+                runner_up = hits;
+                runner_up_uncertain = uncertain;
+            }
+            if (work_limit_exceeded(0)) {
+                break;
             }
         }
-        if (maxhits > 2) {
+        if (maxhits > 2 || work_limit_exceeded(0)) {
             break;   /* do not try other comparison types if one found something */
         }
     }
+    BFREE(mono_designs);
+
+    size_t uncertain_total = max_uncertain + runner_up_uncertain;
+    *out_ambiguous = maxhits <= 2 || (uncertain_total > 0 && maxhits - runner_up <= (long) uncertain_total);
+    if (work_limit_exceeded(0)) {
+        log_debug(__FILE__, MAIN, "Work limit of %d steps exceeded, taking the best design scored so far\n",
+                (int) opt.work_limit);
+        *out_ambiguous = 0;   /* a full scan would exceed the limit even further */
+    }
+    *out_hits = maxhits;
+    *out_runner_up = runner_up;
 
     if (is_debug_logging(MAIN)) {
         if (result) {
-            log_debug(__FILE__, MAIN, "CHOOSING \"%s\" design (%ld hits).\n", result->name, maxhits);
+            log_debug(__FILE__, MAIN, "CHOOSING \"%s\" design (%ld hits, runner-up %ld hits).\n", result->name,
+                    maxhits, runner_up);
         }
         else {
             log_debug(__FILE__, MAIN, "NO DESIGN FOUND WITH EVEN ONE HIT POINT!\n");
@@ -590,4 +783,393 @@ design_t *autodetect_design()
 }
 
 
+
+/**
+ * Add one line of the box frame to a fingerprint. Only visible characters are used, indentation and trailing
+ * whitespace are ignored, and runs of the same character count as one, so that the fingerprint does not depend on
+ * the width of the box.
+ * @param fingerprint the fingerprint so far
+ * @param line the input line to add
+ * @return the new fingerprint
+ */
+static uint64_t add_to_fingerprint(uint64_t fingerprint, line_t *line)
+{
+    uint32_t *visible = get_visible_text(line);
+    size_t end = line->text->num_chars_visible - line->text->trailing;
+    ucs4_t prev = char_nul;
+    for (size_t i = line->text->indent; i < end; i++) {
+        if (visible[i] != prev) {
+            fingerprint = (fingerprint ^ visible[i]) * 0x100000001b3ULL;   /* FNV-1a */
+            prev = visible[i];
+        }
+    }
+    return (fingerprint ^ char_newline) * 0x100000001b3ULL;
+}
+
+
+
+/**
+ * Compute the fingerprint of the box frame in the input, which is made from the first and the last non-blank line.
+ * The names of all designs are added as well, so that cache entries no longer apply once the designs have changed.
+ * @param out_fingerprint pointer to a memory location where the result is stored
+ * @return 1 if a fingerprint was computed, 0 if the input is blank
+ */
+static int frame_fingerprint(uint64_t *out_fingerprint)
+{
+    size_t first = 0;
+    while (first < input.num_lines && bxs_is_blank(input.lines[first].text)) {
+        ++first;
+    }
+    if (first >= input.num_lines) {
+        return 0;
+    }
+    size_t last = input.num_lines - 1;
+    while (last > first && bxs_is_blank(input.lines[last].text)) {
+        --last;
+    }
+
+    uint64_t fingerprint = 0xcbf29ce484222325ULL;
+    fingerprint = add_to_fingerprint(fingerprint, input.lines + first);
+    fingerprint = add_to_fingerprint(fingerprint, input.lines + last);
+    for (int i = 0; i < num_designs; ++i) {
+        for (const char *p = designs[i].name; *p != '\0'; ++p) {
+            fingerprint = (fingerprint ^ (unsigned char) *p) * 0x100000001b3ULL;
+        }
+        fingerprint = (fingerprint ^ char_newline) * 0x100000001b3ULL;
+    }
+    *out_fingerprint = fingerprint;
+    log_debug(__FILE__, MAIN, "Frame fingerprint: %016" PRIx64 "\n", fingerprint);
+    return 1;
+}
+
+
+
+/**
+ * Look up a fingerprint in the cache file. Each line of the cache file consists of a fingerprint in hex notation, a
+ * design name, and the score of the design when it was detected, separated by spaces. Lines in any other format are
+ * ignored. If a fingerprint occurs more than once, the last entry wins.
+ * @param cache_file path to the cache file
+ * @param fingerprint the fingerprint to look up
+ * @param out_hits pointer to a memory location where the cached score is stored
+ * @return the cached design, or NULL if the fingerprint is not in the cache or the design does not exist (anymore)
+ */
+static design_t *lookup_cached_design(const char *cache_file, uint64_t fingerprint, long *out_hits)
+{
+    FILE *f = fopen(cache_file, "r");
+    if (f == NULL) {
+        return NULL;
+    }
+
+    char buf[LINE_MAX_BYTES + 2];
+    char name[LINE_MAX_BYTES + 2];
+    name[0] = '\0';
+    while (fgets(buf, LINE_MAX_BYTES + 2, f)) {
+        uint64_t key;
+        long hits;
+        char tmp[LINE_MAX_BYTES + 2];
+        if (sscanf(buf, "%" SCNx64 " %s %ld", &key, tmp, &hits) == 3 && key == fingerprint) {
+            strcpy(name, tmp);
+            *out_hits = hits;
+        }
+    }
+    fclose(f);
+
+    for (int i = 0; name[0] != '\0' && i < num_designs; ++i) {
+        if (strcmp(designs[i].name, name) == 0) {
+            log_debug(__FILE__, MAIN, "Autodetection cache suggests design \"%s\" (%ld hits)\n", name, *out_hits);
+            return designs + i;
+        }
+    }
+    return NULL;
+}
+
+
+
+/**
+ * Record the autodetection result for a fingerprint in the cache file. An existing entry for the same fingerprint is
+ * replaced, and only the most recent `DETECT_CACHE_MAX_ENTRIES` entries are kept. The file is written to a temporary
+ * file first, which is then renamed, so that parallel runs never see a partially written cache file. When parallel
+ * runs update the cache at the same time, the last one wins, and the entries added by the others are lost.
+ * @param cache_file path to the cache file
+ * @param fingerprint the fingerprint of the box frame
+ * @param design the detected design
+ * @param hits the score of the detected design
+ */
+static void store_cached_design(const char *cache_file, uint64_t fingerprint, design_t *design, long hits)
+{
+    char **entries = NULL;
+    size_t num_entries = 0;
+    int out_of_memory = 0;
+    FILE *f = fopen(cache_file, "r");
+    if (f != NULL) {
+        char buf[LINE_MAX_BYTES + 2];
+        while (!out_of_memory && fgets(buf, LINE_MAX_BYTES + 2, f)) {
+            uint64_t key;
+            long old_hits;
+            char name[LINE_MAX_BYTES + 2];
+            if (sscanf(buf, "%" SCNx64 " %s %ld", &key, name, &old_hits) == 3 && key != fingerprint) {
+                char **grown = (char **) realloc(entries, (num_entries + 1) * sizeof(char *));
+                char *entry = grown != NULL ? strdup(buf) : NULL;
+                if (grown != NULL) {
+                    entries = grown;
+                }
+                if (entry == NULL) {
+                    out_of_memory = 1;
+                }
+                else {
+                    entries[num_entries++] = entry;
+                }
+            }
+        }
+        fclose(f);
+    }
+    size_t first_kept = num_entries >= DETECT_CACHE_MAX_ENTRIES ? num_entries - DETECT_CACHE_MAX_ENTRIES + 1 : 0;
+
+    char *tmp_file = out_of_memory ? NULL : (char *) malloc(strlen(cache_file) + 32);
+    if (tmp_file != NULL) {
+        sprintf(tmp_file, "%s.%ld.tmp", cache_file, (long) getpid());
+        f = fopen(tmp_file, "w");
+    }
+    if (tmp_file == NULL || f == NULL) {
+        log_debug(__FILE__, MAIN, "Failed to write autodetection cache file %s\n", cache_file);
+    }
+    else {
+        for (size_t i = first_kept; i < num_entries; ++i) {
+            fputs(entries[i], f);
+        }
+        fprintf(f, "%016" PRIx64 " %s %ld\n", fingerprint, design->name, hits);
+        int rc = fclose(f);
+        #ifdef _WIN32
+            remove(cache_file);   /* rename() does not replace existing files on Windows */
+        #endif
+        if (rc != 0 || rename(tmp_file, cache_file) != 0) {
+            log_debug(__FILE__, MAIN, "Failed to write autodetection cache file %s\n", cache_file);
+            remove(tmp_file);
+        }
+    }
+
+    for (size_t i = 0; i < num_entries; ++i) {
+        BFREE(entries[i]);
+    }
+    BFREE(entries);
+    BFREE(tmp_file);
+}
+
+
+
+/**
+ * Check whether an input line starts with the given shape line (ignoring indentation).
+ * @return 1 if it does, 0 otherwise
+ */
+static int line_starts_with_shape(design_t *design, shape_t shape, size_t shape_line_idx, comparison_t comp_type,
+        size_t line_idx)
+{
+    uint32_t *shape_relevant = prepare_comp_shape(design, shape, shape_line_idx, comp_type, 1, 0);
+    uint32_t *input_relevant = prepare_comp_input(line_idx, 1, comp_type, 0, NULL, NULL);
+    spend_work(1);
+    int result = u32_strncmp(input_relevant, shape_relevant, u32_strlen(shape_relevant)) == 0;
+    BFREE(shape_relevant);
+    return result;
+}
+
+
+
+/**
+ * Check whether an input line ends with the given shape line (ignoring trailing whitespace).
+ * @return 1 if it does, 0 otherwise
+ */
+static int line_ends_with_shape(design_t *design, shape_t shape, size_t shape_line_idx, comparison_t comp_type,
+        size_t line_idx)
+{
+    uint32_t *shape_relevant = prepare_comp_shape(design, shape, shape_line_idx, comp_type, 0, 1);
+    size_t length_relevant = u32_strlen(shape_relevant);
+    uint32_t *input_relevant = prepare_comp_input(line_idx, 0, comp_type, length_relevant, NULL, NULL);
+    spend_work(1);
+    int result = input_relevant != NULL && u32_strncmp(input_relevant, shape_relevant, length_relevant) == 0;
+    BFREE(shape_relevant);
+    return result;
+}
+
+
+
+/**
+ * Check whether a line of the top or bottom side of the box is matched in full: it must start and end with the
+ * corners, and each horizontal shape must occur in it.
+ * @return 1 if the line matches, 0 otherwise
+ */
+static int horizontal_line_matches(design_t *design, const shape_t *side, shape_t west, shape_t east,
+        size_t shape_line_idx, comparison_t comp_type, size_t line_idx)
+{
+    if (!bxs_is_blank(design->shape[west].mbcs[shape_line_idx])
+            && !line_starts_with_shape(design, west, shape_line_idx, comp_type, line_idx)) {
+        return 0;
+    }
+    if (!bxs_is_blank(design->shape[east].mbcs[shape_line_idx])
+            && !line_ends_with_shape(design, east, shape_line_idx, comp_type, line_idx)) {
+        return 0;
+    }
+
+    uint32_t *input_relevant = prepare_comp_input(line_idx, 1, comp_type, 0, NULL, NULL);
+    size_t input_length = u32_strlen(input_relevant);
+    for (size_t i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+        if (isempty(design->shape + side[i]) || bxs_is_blank(design->shape[side[i]].mbcs[shape_line_idx])) {
+            continue;
+        }
+        uint32_t *shape_relevant = prepare_comp_shape(design, side[i], shape_line_idx, comp_type,
+                is_blankward(design, side[i], shape_line_idx, 1), is_blankward(design, side[i], shape_line_idx, 0));
+        spend_work(1);
+        uint32_t *p = u32_find_first(input_relevant, input_length, shape_relevant, u32_strlen(shape_relevant));
+        BFREE(shape_relevant);
+        if (p == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+/**
+ * Check whether a body line of the box is matched by one of the shapes of a vertical side.
+ * @return 1 if the line matches, or if the side has no visible characters to match; 0 otherwise
+ */
+static int vertical_line_matches(design_t *design, const shape_t *side, int east, comparison_t comp_type,
+        size_t line_idx)
+{
+    int candidates = 0;
+    for (size_t i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+        if (isempty(design->shape + side[i])) {
+            continue;
+        }
+        for (size_t j = 0; j < design->shape[side[i]].height; ++j) {
+            if (bxs_is_blank(design->shape[side[i]].mbcs[j])) {
+                continue;
+            }
+            ++candidates;
+            if (east ? line_ends_with_shape(design, side[i], j, comp_type, line_idx)
+                    : line_starts_with_shape(design, side[i], j, comp_type, line_idx)) {
+                return 1;
+            }
+        }
+    }
+    return candidates == 0;
+}
+
+
+
+/**
+ * Check whether a design matches the whole frame of the box in the input: every line of the top and bottom sides is
+ * matched in full, and every (sampled) body line is matched by the left and right sides.
+ * @param design the design to check
+ * @param comp_type the comparison type (how to compare colored strings)
+ * @return 1 if the design matches the whole frame, 0 otherwise
+ */
+static int design_frames_input(design_t *design, comparison_t comp_type)
+{
+    int *empty = determine_empty_sides(design);
+    size_t top = empty[BTOP] ? 0 : design->shape[NW].height;
+    size_t bottom = empty[BBOT] ? 0 : design->shape[SW].height;
+    int result = top + bottom <= input.num_lines;
+
+    for (size_t k = 0; result && k < top; ++k) {
+        result = horizontal_line_matches(design, north_side, NW, NE, k, comp_type, k);
+    }
+    for (size_t k = 0; result && k < bottom; ++k) {
+        result = horizontal_line_matches(design, south_side, SW, SE, k, comp_type, input.num_lines - bottom + k);
+    }
+
+    size_t body_start = top;
+    size_t body_end = input.num_lines - bottom;
+    int sampled = input.num_lines >= SAMPLE_MIN_INPUT_LINES;
+    for (size_t k = body_start; result && k < body_end; k = next_body_line(design, k, body_start, body_end, sampled)) {
+        result = (empty[BLEF] || vertical_line_matches(design, west_side, 0, comp_type, k))
+                && (empty[BRIG] || vertical_line_matches(design, east_side, 1, comp_type, k));
+    }
+
+    BFREE(empty);
+    log_debug(__FILE__, MAIN, "Design \"%s\" %s the whole frame\n", design->name, result ? "matches" : "does NOT match");
+    return result;
+}
+
+
+
+/**
+ * Check whether a design suggested by the cache really frames the input. Its score must be the same as when it was
+ * detected, which is what a full detection would arrive at again, and it must match the whole frame of the box.
+ * @param design the cached design
+ * @param cached_hits the score of the design when it was detected
+ * @param mono_input flag indicating that there are no invisible characters in the input
+ * @return 1 if the design can be trusted, 0 otherwise
+ */
+static int cached_design_matches(design_t *design, long cached_hits, int mono_input)
+{
+    int mono_design = design_is_mono(design);
+    for (comparison_t comp_type = 0; comp_type < NUM_COMPARISON_TYPES; comp_type++) {
+        if (comp_type_is_viable(comp_type, mono_input, mono_design)) {
+            size_t uncertain = 0;
+            long hits = match_design(design, comp_type, input.num_lines >= SAMPLE_MIN_INPUT_LINES ? &uncertain : NULL);
+            if (hits != cached_hits && uncertain > 0) {
+                hits = match_design(design, comp_type, NULL);   /* the cached score may be from a full scan */
+            }
+            log_debug(__FILE__, MAIN, "Cached design \"%s\" scored %ld points\n", design->name, hits);
+            if (hits > 2) {
+                return hits == cached_hits && design_frames_input(design, comp_type);
+            }
+        }
+    }
+    return 0;
+}
+
+
+
+design_t *autodetect_design()
+{
+    return autodetect_design_scored(NULL);
+}
+
+
+
+design_t *autodetect_design_scored(long *out_scores)
+{
+    int mono_input = input_is_mono();
+    int ambiguous = 1;
+    design_t *result = NULL;
+    long hits = 0;
+    long runner_up = 0;
+    (void) comparison_name;             /* used only in debug statements */
+
+    char *cache_file = getenv(DETECT_CACHE_ENV);
+    uint64_t fingerprint = 0;
+    design_t *cached = NULL;
+    long cached_hits = 0;
+    int use_cache = out_scores == NULL && cache_file != NULL && cache_file[0] != '\0'
+            && frame_fingerprint(&fingerprint);
+    if (use_cache) {
+        cached = lookup_cached_design(cache_file, fingerprint, &cached_hits);
+        if (cached != NULL && cached_design_matches(cached, cached_hits, mono_input)) {
+            log_debug(__FILE__, MAIN, "CHOOSING \"%s\" design from autodetection cache.\n", cached->name);
+            return cached;
+        }
+    }
+
+    if (input.num_lines >= SAMPLE_MIN_INPUT_LINES) {
+        log_debug(__FILE__, MAIN, "Sampling %d input lines for design detection\n", (int) input.num_lines);
+        result = score_designs(mono_input, 1, &ambiguous, out_scores, &hits, &runner_up);
+        if (ambiguous) {
+            log_debug(__FILE__, MAIN, "Sampled scores are ambiguous, falling back to full scan\n");
+        }
+    }
+    if (ambiguous) {
+        result = score_designs(mono_input, 0, &ambiguous, out_scores, &hits, &runner_up);
+    }
+
+    /* Only store what the next run will accept, so that a design which does not frame the input is not looked up and
+       rejected over and over again. */
+    if (use_cache && result != NULL && cached_design_matches(result, hits, mono_input)) {
+        store_cached_design(cache_file, fingerprint, result, hits);
+    }
+    return result;
+}
+
+
 /* vim: set cindent sw=4: */
@@ -55,8 +55,38 @@ extern char *comparison_name[];
 int comp_type_is_viable(comparison_t comp_type, int mono_input, int mono_design);
 
 
+/**
+ * Determine the comparison type which gives the same result as `comp_type` when comparing a specific input line to
+ * specific shape lines. Ignoring invisible characters makes no difference where there are none, so for example, a
+ * monochrome input line is compared in the same way by `ignore_invisible_input` and `literal`.
+ * @param comp_type comparison type
+ * @param mono_line flag indicating that there are no invisible characters in the input line
+ * @param mono_shapes flag indicating that there are no invisible characters in the shape lines
+ * @return the simplest comparison type which is equivalent to `comp_type` in this case
+ */
+comparison_t effective_comp_type(comparison_t comp_type, int mono_line, int mono_shapes);
+
+
+/**
+ * Count steps spent on design detection and box removal against the work limit (`--work-limit`). A step is one
+ * comparison of a shape line with an input line. The steps are counted per input in `input.work_spent`.
+ * @param steps the number of steps to add
+ */
+void spend_work(size_t steps);
+
+
+/**
+ * Determine whether the work limit (`--work-limit`) has been exceeded. This does not modify anything, so it may be
+ * called from worker threads, which count their steps separately until they are done.
+ * @param pending_steps the number of steps spent, but not yet counted via `spend_work()`
+ * @return flag indicating that the work limit has been exceeded, always 0 if there is no work limit
+ */
+int work_limit_exceeded(size_t pending_steps);
+
+
 /**
  * Determine whether the input text contains ANSI escape codes (i.e. it is potentially colored) or not.
+ * This was determined by `analyze_input()`.
  * @return 1 if no invisible characters are in the input, 0 if there are any
  */
 int input_is_mono();
@@ -110,12 +140,25 @@ uint32_t *prepare_comp_input(size_t input_line_idx, int trim_left, comparison_t
 /**
  * Autodetect design used by box in input.
  * This requires knowledge about ALL designs, so the entire config file had to be parsed at some earlier time.
+ * On large inputs, only a sample of the body lines is checked for vertical shapes. A full scan is performed only when
+ * the sampled scores do not produce a clear winner.
  * @return != NULL: success, pointer to detected design;
  *         == NULL: on error
  */
 design_t *autodetect_design();
 
 
+/**
+ * Autodetect design used by box in input, like `autodetect_design()`, but also report the scores of all designs.
+ * The autodetection cache is not used, because it would provide only the score of the cached design.
+ * @param out_scores array of `num_designs` elements, which receives the score of each design in the order of the
+ *          global `designs` array (0 for designs which were not considered)
+ * @return != NULL: success, pointer to detected design;
+ *         == NULL: on error
+ */
+design_t *autodetect_design_scored(long *out_scores);
+
+
 #endif /* BOXES_DETECT_H */
 
 
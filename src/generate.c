@@ -22,6 +22,10 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <strings.h>
+#ifndef __MINGW32__
+    #include <pthread.h>
+#endif
 
 #include <unistr.h>
 
@@ -34,8 +38,211 @@
 
 
 
-static int horiz_precalc(const sentry_t *sarr,
-                         size_t *topiltf, size_t *botiltf, size_t *hspace)
+/** the minimum number of output lines each worker thread gets when composing the lines of a box in parallel */
+#define MIN_ROWS_PER_THREAD 2048
+
+/** the maximum number of worker threads used for composing the lines of a box */
+#define MAX_ROW_THREADS 8
+
+/** the maximum number of output lines each worker thread composes before its lines are written */
+#define MAX_ROWS_PER_CHUNK 16384
+
+/** name of the environment variable which turns off the fast paths for simple sides and pure ASCII, for benchmarking */
+#define GENERAL_COMPOSER_ENV "BOXES_GENERAL_COMPOSER"
+
+
+
+/**
+ * How one side of the box grows with the size of the box. This follows the rules by which the box sides used to be
+ * extended step by step: In the first step, the non-elastic shapes are added along with an elastic shape. Every further
+ * step adds one elastic shape. If there are two elastic shapes, they take turns, starting with the first one.
+ */
+typedef struct {
+    /** the sides of the non-elastic shapes, which are added once, indexed like `iltf` */
+    size_t base_iltf[SHAPES_PER_SIDE - 2];
+
+    /** the sum of `base_iltf` */
+    size_t base;
+
+    /** the indexes into `iltf` of the elastic shapes added in odd and even steps (equal if there is only one) */
+    int elastic[2];
+
+    /** the sizes of the two elastic shapes */
+    size_t elastic_size[2];
+
+    /** the growth of the side in every two steps */
+    size_t period;
+
+    /** the number of steps in which the side grows by `period` (1 or 2) */
+    size_t period_steps;
+} side_growth_t;
+
+
+
+static size_t shape_size(const sentry_t *shape, int vertical)
+{
+    return vertical ? shape->height : shape->width;
+}
+
+
+
+/**
+ * Determine how one side of the box grows with the size of the box.
+ * @param sarr all shapes of the current design
+ * @param seite the side (`north_side`, `south_side`, `west_side`, or `east_side`)
+ * @param vertical flag indicating that the side is vertical, so that the heights of its shapes are relevant
+ * @param result (OUT) the description of how the side grows
+ * @return == 0 on success; != 0 if the side has no shapes to grow by (which the config file parser prevents)
+ */
+static int side_growth(const sentry_t *sarr, const shape_t *seite, int vertical, side_growth_t *result)
+{
+    int numsh = 0;                   /* number of existent shapes in the middle of the side */
+    for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+        if (!isempty(sarr + seite[i])) {
+            numsh++;
+        }
+    }
+
+    memset(result, 0, sizeof(side_growth_t));
+    result->elastic[0] = -1;
+    for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+        const sentry_t *shape = sarr + seite[i];
+        if (isempty(shape)) {
+            continue;
+        }
+        if (numsh == 1 || shape->elastic) {
+            if (result->elastic[0] < 0) {
+                result->elastic[0] = i - 1;
+            }
+        }
+        else if (numsh == 3 || result->base == 0) {
+            /* with two shapes, the non-elastic one; with three shapes, all non-elastic ones */
+            result->base_iltf[i - 1] = shape_size(shape, vertical);
+            result->base += result->base_iltf[i - 1];
+        }
+    }
+    if (result->elastic[0] < 0 || numsh < 1 || numsh > 3) {
+        return 1;
+    }
+
+    result->elastic[1] = result->elastic[0];
+    if (numsh == 3 && sarr[seite[1]].elastic && sarr[seite[3]].elastic) {
+        result->elastic[1] = 2;
+    }
+    for (int j = 0; j < 2; ++j) {
+        result->elastic_size[j] = shape_size(sarr + seite[result->elastic[j] + 1], vertical);
+    }
+    result->period_steps = result->elastic[0] == result->elastic[1] ? 1 : 2;
+    result->period = result->elastic_size[0] + (result->period_steps == 2 ? result->elastic_size[1] : 0);
+    return result->period == 0 ? 1 : 0;
+}
+
+
+
+/**
+ * Find the smallest number which is at least `min_value` and which can be written both as `a1 + m1 * p1` and as
+ * `a2 + m2 * p2`, with non-negative integers `m1` and `m2`.
+ * @return the number, or 0 if there is none
+ */
+static size_t smallest_common_value(size_t a1, size_t p1, size_t a2, size_t p2, size_t min_value)
+{
+    /* extended Euclidean algorithm: find g = gcd(p1, p2) and s with p1 * s = g (mod p2) */
+    long long old_r = (long long) p1, r = (long long) p2;
+    long long old_s = 1, s = 0;
+    while (r != 0) {
+        long long q = old_r / r;
+        long long tmp = r;
+        r = old_r - q * r;
+        old_r = tmp;
+        tmp = s;
+        s = old_s - q * s;
+        old_s = tmp;
+    }
+    long long g = old_r;
+    long long diff = (long long) a2 - (long long) a1;
+    if (diff % g != 0) {
+        return 0;
+    }
+
+    /* a1 + p1 * t hits the second progression if p1 * t = diff (mod p2) */
+    long long modulus = (long long) p2 / g;
+    long long t = ((diff / g) % modulus) * (old_s % modulus) % modulus;
+    if (t < 0) {
+        t += modulus;
+    }
+    long long lcm = (long long) p1 / g * (long long) p2;
+    long long result = (long long) a1 + (long long) p1 * t;
+    long long lower = (long long) BMAX(min_value, BMAX(a1, a2));
+    if (result < lower) {
+        result += (lower - result + lcm - 1) / lcm * lcm;
+    }
+    return (size_t) result;
+}
+
+
+
+/**
+ * Calculate how often the shapes of two opposite sides of the box must be repeated. Both sides are grown in the way
+ * described by `side_growth_t` until they have the same size, which must be at least the target size. This is done in
+ * constant time, by considering the sizes each side can reach as (one or two) arithmetic progressions, and finding the
+ * smallest size they have in common. The result is the same as if the sides were grown step by step, always extending
+ * the one which is behind.
+ * @param sarr all shapes of the current design
+ * @param side1 the first side (`north_side` or `west_side`)
+ * @param side2 the opposite side (`south_side` or `east_side`)
+ * @param vertical flag indicating that the sides are vertical, so that the heights of the shapes are relevant
+ * @param target the minimum size of the sides, excluding corners
+ * @param iltf1 (OUT) the number of columns or lines to fill by shapes 1, 2, and 3 of `side1`
+ * @param iltf2 (OUT) the number of columns or lines to fill by shapes 1, 2, and 3 of `side2`
+ * @param space (OUT) the size of both sides, excluding corners (sum over `iltf1` or `iltf2`)
+ * @return == 0 on success; != 0 on error
+ */
+static int sides_precalc(const sentry_t *sarr, const shape_t *side1, const shape_t *side2, int vertical,
+                         size_t target, size_t *iltf1, size_t *iltf2, size_t *space)
+{
+    side_growth_t growth[2];
+    if (side_growth(sarr, side1, vertical, growth) || side_growth(sarr, side2, vertical, growth + 1)) {
+        bx_fprintf(stderr, "%s: internal error in %s_precalc()\n", PROJECT, vertical ? "vert" : "horiz");
+        return 1;
+    }
+
+    /* After k >= 1 steps, a side has grown to base + elastic_size[0] + (k - 1) / period_steps * period, plus
+       elastic_size[1] for even k if it takes turns. So the sizes it can reach form one progression per phase. */
+    size_t result = 0;
+    for (size_t phase1 = 0; phase1 < growth[0].period_steps; ++phase1) {
+        size_t a1 = growth[0].base + growth[0].elastic_size[0] + (phase1 == 1 ? growth[0].elastic_size[1] : 0);
+        for (size_t phase2 = 0; phase2 < growth[1].period_steps; ++phase2) {
+            size_t a2 = growth[1].base + growth[1].elastic_size[0] + (phase2 == 1 ? growth[1].elastic_size[1] : 0);
+            size_t value = smallest_common_value(a1, growth[0].period, a2, growth[1].period, target);
+            if (value > 0 && (result == 0 || value < result)) {
+                result = value;
+            }
+        }
+    }
+    if (result == 0) {
+        bx_fprintf(stderr, "%s: internal error in %s_precalc()\n", PROJECT, vertical ? "vert" : "horiz");
+        return 1;
+    }
+
+    size_t *iltf[2] = {iltf1, iltf2};
+    for (int i = 0; i < 2; ++i) {
+        side_growth_t *g = growth + i;
+        size_t grown = result - g->base;
+        size_t steps = grown / g->period * g->period_steps + (grown % g->period != 0 ? 1 : 0);
+        memcpy(iltf[i], g->base_iltf, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
+        iltf[i][g->elastic[0]] += (g->period_steps == 2 ? (steps + 1) / 2 : steps) * g->elastic_size[0];
+        if (g->period_steps == 2) {
+            iltf[i][g->elastic[1]] += steps / 2 * g->elastic_size[1];
+        }
+    }
+    *space = result;
+    return 0;
+}
+
+
+
+int horiz_precalc(const sentry_t *sarr,
+                  size_t *topiltf, size_t *botiltf, size_t *hspace)
 /*
  *  Calculate data for horizontal box side generation.
  *
@@ -51,20 +258,7 @@ static int horiz_precalc(const sentry_t *sarr,
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  */
 {
-    int tnumsh;               /* number of existent shapes in top part */
-    int bnumsh;
-    size_t twidth;            /* current hspace for top side */
-    size_t bwidth;            /* current hspace for bottom side */
-    int i;
     size_t target_width;      /* assumed text width for minimum box size */
-    int btoggle, ttoggle;     /* for case 3 w/ 2 elastics */
-
-    /*
-     *  Initialize future result values
-     */
-    memset(topiltf, 0, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
-    memset(botiltf, 0, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
-    *hspace = 0;
 
     /*
      *  Ensure minimum width for the insides of a box in order to ensure
@@ -79,154 +273,19 @@ static int horiz_precalc(const sentry_t *sarr,
                 sarr[north_side[SHAPES_PER_SIDE - 1]].width;
     }
 
-    /*
-     *  Compute number of existent shapes in top and in bottom part
-     */
-    tnumsh = 0;
-    bnumsh = 0;
-    for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-        if (!isempty(sarr + north_side[i])) {
-            tnumsh++;
-        }
-        if (!isempty(sarr + south_side[i])) {
-            bnumsh++;
-        }
-    }
-
     if (is_debug_logging(MAIN)) {
         log_debug(__FILE__, MAIN, "in horiz_precalc:\n");
-        log_debug(__FILE__, MAIN, "    opt.design->minwidth %d, input.maxline %d, target_width"
-            " %d, tnumsh %d, bnumsh %d\n", (int) opt.design->minwidth,
-             (int) input.maxline, (int) target_width, tnumsh, bnumsh);
-    }
-
-    twidth = 0;
-    bwidth = 0;
-
-    btoggle = 1;                         /* can be 1 or 3 */
-    ttoggle = 1;
-
-    do {
-        shape_t *seite;                  /* ptr to north_side or south_side */
-        size_t *iltf;                    /* ptr to botiltf or topiltf */
-        size_t *res_hspace;              /* ptr to bwidth or twidth */
-        int *stoggle;                    /* ptr to btoggle or ttoggle */
-        int numsh;                       /* either bnumsh or tnumsh */
-
-        /*
-         *  Set pointers to the side which is currently shorter,
-         *  so it will be advanced in this step.
-         */
-        if (twidth > bwidth) {           /* south (bottom) is behind */
-            seite = south_side;
-            iltf = botiltf;
-            res_hspace = &bwidth;
-            numsh = bnumsh;
-            stoggle = &btoggle;
-        }
-        else {                           /* north (top) is behind */
-            seite = north_side;
-            iltf = topiltf;
-            res_hspace = &twidth;
-            numsh = tnumsh;
-            stoggle = &ttoggle;
-        }
-
-        switch (numsh) {
-
-            case 1:
-                /*
-                 *  only one shape -> it must be elastic
-                 */
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!isempty(&(sarr[seite[i]]))) {
-                        if (iltf[i - 1] == 0 ||
-                                *res_hspace < target_width ||
-                                twidth != bwidth) {
-                            iltf[i - 1] += sarr[seite[i]].width;
-                            *res_hspace += sarr[seite[i]].width;
-                        }
-                        break;
-                    }
-                }
-                break;
-
-            case 2:
-                /*
-                 *  two shapes -> one must be elastic, the other must not
-                 */
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!isempty(sarr + seite[i]) && !(sarr[seite[i]].elastic)) {
-                        if (iltf[i - 1] == 0) {
-                            iltf[i - 1] += sarr[seite[i]].width;
-                            *res_hspace += sarr[seite[i]].width;
-                            break;
-                        }
-                    }
-                }
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!isempty(sarr + seite[i]) && sarr[seite[i]].elastic) {
-                        if (iltf[i - 1] == 0 ||
-                                *res_hspace < target_width ||
-                                twidth != bwidth) {
-                            iltf[i - 1] += sarr[seite[i]].width;
-                            *res_hspace += sarr[seite[i]].width;
-                        }
-                        break;
-                    }
-                }
-                break;
-
-            case 3:
-                /*
-                 *  three shapes -> one or two of them must be elastic
-                 *  If two are elastic, they are the two outer ones.
-                 */
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!(sarr[seite[i]].elastic) && iltf[i - 1] == 0) {
-                        iltf[i - 1] += sarr[seite[i]].width;
-                        *res_hspace += sarr[seite[i]].width;
-                    }
-                }
-                if (sarr[seite[1]].elastic && sarr[seite[3]].elastic) {
-                    if (iltf[*stoggle - 1] == 0 ||
-                            *res_hspace < target_width ||
-                            twidth != bwidth) {
-                        *res_hspace += sarr[seite[*stoggle]].width;
-                        iltf[*stoggle - 1] += sarr[seite[*stoggle]].width;
-                    }
-                    *stoggle = *stoggle == 1 ? 3 : 1;
-                }
-                else {
-                    for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                        if (sarr[seite[i]].elastic) {
-                            if (iltf[i - 1] == 0 ||
-                                    *res_hspace < target_width ||
-                                    twidth != bwidth) {
-                                iltf[i - 1] += sarr[seite[i]].width;
-                                *res_hspace += sarr[seite[i]].width;
-                            }
-                            break;
-                        }
-                    }
-                }
-                break;
-
-            default:
-                bx_fprintf(stderr, "%s: internal error in horiz_precalc()\n", PROJECT);
-                return 1;
-        }
-    } while (twidth != bwidth || twidth < target_width || bwidth < target_width);
-
-    *hspace = twidth;                    /* return either one */
+        log_debug(__FILE__, MAIN, "    opt.design->minwidth %d, input.maxline %d, target_width %d\n",
+                (int) opt.design->minwidth, (int) input.maxline, (int) target_width);
+    }
 
-    return 0;                            /* all clear */
+    return sides_precalc(sarr, north_side, south_side, 0, target_width, topiltf, botiltf, hspace);
 }
 
 
 
-static int vert_precalc(const sentry_t *sarr,
-                        size_t *leftiltf, size_t *rightiltf, size_t *vspace)
+int vert_precalc(const sentry_t *sarr,
+                 size_t *leftiltf, size_t *rightiltf, size_t *vspace)
 /*
  *  Calculate data for vertical box side generation.
  *
@@ -242,20 +301,7 @@ static int vert_precalc(const sentry_t *sarr,
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  */
 {
-    int lnumsh;               /* number of existent shapes in top part */
-    int rnumsh;
-    size_t lheight;           /* current vspace for top side */
-    size_t rheight;           /* current vspace for bottom side */
-    int i;
     size_t target_height;     /* assumed text height for minimum box size */
-    int rtoggle, ltoggle;     /* for case 3 w/ 2 elastics */
-
-    /*
-     *  Initialize future result values
-     */
-    memset(leftiltf, 0, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
-    memset(rightiltf, 0, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
-    *vspace = 0;
 
     /*
      *  Ensure minimum height for insides of box in order to ensure
@@ -270,291 +316,169 @@ static int vert_precalc(const sentry_t *sarr,
                 sarr[west_side[SHAPES_PER_SIDE - 1]].height;
     }
 
-    /*
-     *  Compute number of existent shapes in left and right part (1..3)
-     */
-    lnumsh = 0;
-    rnumsh = 0;
-    for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-        if (!isempty(sarr + west_side[i])) {
-            lnumsh++;
-        }
-        if (!isempty(sarr + east_side[i])) {
-            rnumsh++;
-        }
-    }
-
-    lheight = 0;
-    rheight = 0;
-
-    rtoggle = 1;                         /* can be 1 or 3 */
-    ltoggle = 1;
-
-    do {
-        shape_t *seite;                  /* ptr to west_side or east_side */
-        size_t *iltf;                    /* ptr to rightiltf or leftiltf */
-        size_t *res_vspace;              /* ptr to rheight or lheight */
-        int *stoggle;                    /* ptr to rtoggle or ltoggle */
-        int numsh;                       /* either rnumsh or lnumsh */
-
-        /*
-         *  Set pointers to the side which is currently shorter,
-         *  so it will be advanced in this step.
-         */
-        if (lheight > rheight) {         /* east (right) is behind */
-            seite = east_side;
-            iltf = rightiltf;
-            res_vspace = &rheight;
-            numsh = rnumsh;
-            stoggle = &rtoggle;
-        }
-        else {                           /* west (left) is behind */
-            seite = west_side;
-            iltf = leftiltf;
-            res_vspace = &lheight;
-            numsh = lnumsh;
-            stoggle = &ltoggle;
-        }
-
-        switch (numsh) {
-
-            case 1:
-                /*
-                 *  only one shape -> it must be elastic
-                 */
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!isempty(&(sarr[seite[i]]))) {
-                        if (iltf[i - 1] == 0 ||
-                                *res_vspace < target_height ||
-                                lheight != rheight) {
-                            iltf[i - 1] += sarr[seite[i]].height;
-                            *res_vspace += sarr[seite[i]].height;
-                        }
-                        break;
-                    }
-                }
-                break;
-
-            case 2:
-                /*
-                 *  two shapes -> one must be elastic, the other must not
-                 */
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!isempty(sarr + seite[i]) && !(sarr[seite[i]].elastic)) {
-                        if (iltf[i - 1] == 0) {
-                            iltf[i - 1] += sarr[seite[i]].height;
-                            *res_vspace += sarr[seite[i]].height;
-                            break;
-                        }
-                    }
-                }
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!isempty(sarr + seite[i]) && sarr[seite[i]].elastic) {
-                        if (iltf[i - 1] == 0 ||
-                                *res_vspace < target_height ||
-                                lheight != rheight) {
-                            iltf[i - 1] += sarr[seite[i]].height;
-                            *res_vspace += sarr[seite[i]].height;
-                        }
-                        break;
-                    }
-                }
-                break;
-
-            case 3:
-                /*
-                 *  three shapes -> one or two of them must be elastic
-                 *  If two are elastic, they are the two outer ones.
-                 */
-                for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                    if (!(sarr[seite[i]].elastic) && iltf[i - 1] == 0) {
-                        iltf[i - 1] += sarr[seite[i]].height;
-                        *res_vspace += sarr[seite[i]].height;
-                    }
-                }
-                if (sarr[seite[1]].elastic && sarr[seite[3]].elastic) {
-                    if (iltf[*stoggle - 1] == 0 ||
-                            *res_vspace < target_height ||
-                            lheight != rheight) {
-                        *res_vspace += sarr[seite[*stoggle]].height;
-                        iltf[*stoggle - 1] += sarr[seite[*stoggle]].height;
-                    }
-                    *stoggle = *stoggle == 1 ? 3 : 1;
-                }
-                else {
-                    for (i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
-                        if (sarr[seite[i]].elastic) {
-                            if (iltf[i - 1] == 0 ||
-                                    *res_vspace < target_height ||
-                                    lheight != rheight) {
-                                iltf[i - 1] += sarr[seite[i]].height;
-                                *res_vspace += sarr[seite[i]].height;
-                            }
-                            break;
-                        }
-                    }
-                }
-                break;
-
-            default:
-                bx_fprintf(stderr, "%s: internal error in vert_precalc()\n", PROJECT);
-                return 1;
-        }
-    } while (lheight != rheight || lheight < target_height || rheight < target_height);
-
-    *vspace = lheight;                   /* return either one */
-
-    return 0;                            /* all clear */
+    return sides_precalc(sarr, west_side, east_side, 1, target_height, leftiltf, rightiltf, vspace);
 }
 
 
 
 /**
- * Calculate the maximum number of characters in a line of a horizontal side (top or bottom). This excludes corners,
- * which always belong to the vertical sides. This is needed for allocating space for the assembled sides, which will
- * include shapes multiple times, and also include invisible characters.
- * @param sarr all shapes of the current design
- * @param side the side to calculate (`north_side` or `south_side`)
- * @param iltf the numbers of times that a shape shall appear (array of *three* values)
- * @param target_width the number of columns we must reach
- * @param target_height the number of lines of the side
- * @return the number of characters(!), visible plus invisible, that suffice to store every line of that side
+ * Fill memory with copies of a block. After the first copy, the part already filled is copied again and again, which
+ * doubles it every time, so that only a logarithmic number of calls to `memcpy()` is needed.
+ * @param dest where to put the copies, must have room for `count * size` bytes
+ * @param block the block to copy
+ * @param size the size of the block in bytes
+ * @param count the number of copies
  */
-static size_t horiz_chars_required(const sentry_t *sarr, const shape_t *side, size_t *iltf, size_t target_width,
-    size_t target_height)
+static void fill_repeated(void *dest, const void *block, size_t size, size_t count)
 {
-    size_t *lens = (size_t *) calloc(target_height, sizeof(size_t));
-    size_t *iltf_copy = (size_t *) malloc(3 * sizeof(size_t));
-    memcpy(iltf_copy, iltf, 3 * sizeof(size_t));
-
-    int cshape = (side == north_side) ? 0 : 2;
-    for (size_t j = 0; j < target_width; j += sarr[side[cshape + 1]].width) {
-        while (iltf_copy[cshape] == 0) {
-            cshape += (side == north_side) ? 1 : -1;
-        }
-        for (size_t line = 0; line < target_height; ++line) {
-            lens[line] += sarr[side[cshape + 1]].mbcs[line]->num_chars;
-        }
-        iltf_copy[cshape] -= sarr[side[cshape + 1]].width;
+    size_t total = size * count;
+    if (total == 0) {
+        return;
     }
-
-    size_t result = 0;
-    for (size_t i = 0; i < target_height; i++) {
-        if (lens[i] > result) {
-            result = lens[i];
-        }
+    memcpy(dest, block, size);
+    size_t filled = size;
+    while (filled < total) {
+        size_t chunk = BMIN(filled, total - filled);
+        memcpy((char *) dest + filled, dest, chunk);
+        filled += chunk;
     }
-
-    BFREE(lens);
-    BFREE(iltf_copy);
-    log_debug(__FILE__, MAIN, "%s side required characters: %d\n",
-        (side == north_side) ? "Top": "Bottom", (int) result);
-    return result;
 }
 
 
 
-static int vert_assemble(const sentry_t *sarr, const shape_t *seite,
-                         size_t *iltf, sentry_t *result)
-/*
- *  RETURNS:  == 0   on success  (result values are set)
- *            != 0   on error
- *
-* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+/**
+ * Assemble a horizontal side (top or bottom) of the box, excluding the corners, which always belong to the vertical
+ * sides. Each line is built in memory of exactly the required size, and the repetitions of each shape are filled in
+ * by `fill_repeated()`, so that the effort is linear in the width of the box.
+ * @param sarr all shapes of the current design
+ * @param seite the side to assemble (`north_side` or `south_side`)
+ * @param iltf the numbers of columns to fill by the three middle shapes of the side; always a multiple of the width of
+ *      the respective shape
+ * @param result the side to fill, whose `width` and `height` are already set
+ * @return == 0 on success (`result` lines are set);
+ *         != 0 on error
  */
+static int vert_assemble(const sentry_t *sarr, const shape_t *seite, size_t *iltf, sentry_t *result)
 {
-    size_t j;
-    size_t line;
-    int cshape;                      /* current shape (idx to iltf) */
+    /* the middle shapes from left to right, and how many times each one appears */
+    const sentry_t *shapes[SHAPES_PER_SIDE - 2];
+    size_t reps[SHAPES_PER_SIDE - 2];
+    for (size_t i = 0; i < SHAPES_PER_SIDE - 2; ++i) {
+        size_t cshape = (seite == north_side) ? i : SHAPES_PER_SIDE - 3 - i;
+        shapes[i] = sarr + seite[cshape + 1];
+        reps[i] = shapes[i]->width > 0 ? iltf[cshape] / shapes[i]->width : 0;
+    }
 
-    size_t max_chars = horiz_chars_required(sarr, seite, iltf, result->width, result->height);
-    uint32_t **mbcs_tmp = (uint32_t **) calloc(result->height, sizeof(uint32_t *));
+    for (size_t line = 0; line < result->height; ++line) {
+        size_t num_ascii = 0;
+        size_t num_chars = 0;
+        for (size_t i = 0; i < SHAPES_PER_SIDE - 2; ++i) {
+            if (reps[i] > 0) {
+                num_ascii += reps[i] * strlen(shapes[i]->chars[line]);
+                num_chars += reps[i] * shapes[i]->mbcs[line]->num_chars;
+            }
+        }
 
-    for (line = 0; line < result->height; ++line) {
-        result->chars[line] = (char *) calloc(1, result->width + 1);
-        if (result->chars[line] == NULL) {
+        char *ascii = (char *) malloc(num_ascii + 1);
+        uint32_t *mbcs = (uint32_t *) malloc((num_chars + 1) * sizeof(uint32_t));
+        if (ascii == NULL || mbcs == NULL) {
             perror(PROJECT);
-            if ((long) --line >= 0) {
-                do {
-                    BFREE (mbcs_tmp[line]);
-                    BFREE (result->chars[line--]);
-                } while ((long) line >= 0);
+            BFREE(ascii);
+            BFREE(mbcs);
+            for (size_t j = 0; j < line; ++j) {
+                BFREE(result->chars[j]);
+                bxs_free(result->mbcs[j]);
+                result->mbcs[j] = NULL;
             }
-            BFREE(mbcs_tmp);
             return 1;                    /* out of memory */
         }
-        mbcs_tmp[line] = (uint32_t *) calloc(max_chars + 1, sizeof(uint32_t));
-    }
 
-    cshape = (seite == north_side) ? 0 : 2;
-
-    for (j = 0; j < result->width; j += sarr[seite[cshape + 1]].width) {
-        while (iltf[cshape] == 0) {
-            cshape += (seite == north_side) ? 1 : -1;
-        }
-        for (line = 0; line < result->height; ++line) {
-            strcat(result->chars[line], sarr[seite[cshape + 1]].chars[line]);
-            u32_strcat(mbcs_tmp[line], sarr[seite[cshape + 1]].mbcs[line]->memory);
+        char *ascii_pos = ascii;
+        uint32_t *mbcs_pos = mbcs;
+        for (size_t i = 0; i < SHAPES_PER_SIDE - 2; ++i) {
+            if (reps[i] > 0) {
+                size_t ascii_len = strlen(shapes[i]->chars[line]);
+                size_t mbcs_len = shapes[i]->mbcs[line]->num_chars;
+                fill_repeated(ascii_pos, shapes[i]->chars[line], ascii_len, reps[i]);
+                fill_repeated(mbcs_pos, shapes[i]->mbcs[line]->memory, mbcs_len * sizeof(uint32_t), reps[i]);
+                ascii_pos += reps[i] * ascii_len;
+                mbcs_pos += reps[i] * mbcs_len;
+            }
         }
-        iltf[cshape] -= sarr[seite[cshape + 1]].width;
-    }
+        *ascii_pos = '\0';
+        set_char_at(mbcs_pos, 0, char_nul);
 
-    for (line = 0; line < result->height; ++line) {
-        result->mbcs[line] = bxs_from_unicode(mbcs_tmp[line]);
+        result->chars[line] = ascii;
+        result->mbcs[line] = bxs_from_unicode(mbcs);
+        BFREE(mbcs);
     }
-
-    BFREE(mbcs_tmp);
     return 0;                            /* all clear */
 }
 
 
 
-static void horiz_assemble(const sentry_t *sarr, const shape_t *seite,
-                           size_t *iltf, sentry_t *result)
+/**
+ * Describe a vertical side (left or right) of the box by its shapes, including the corners. The side is not assembled
+ * line by line; its lines are looked up by `vert_side_line()` when they are output.
+ * @param sarr all shapes of the current design
+ * @param seite the side to describe (`west_side` or `east_side`)
+ * @param iltf the numbers of lines to fill by the three middle shapes of the side
+ * @param result the side to fill, whose `width` and `height` are already set
+ */
+static void vert_side_init(const sentry_t *sarr, const shape_t *seite, const size_t *iltf, vert_side_t *result)
 {
-    size_t j;
-    size_t sc;                       /* index to shape chars (lines) */
-    int cshape;                      /* current shape (idx to iltf) */
-    shape_t ctop, cbottom;
-
-    if (seite == east_side) {
-        ctop = seite[0];
-        cbottom = seite[SHAPES_PER_SIDE - 1];
-        cshape = 0;
-    }
-    else {
-        ctop = seite[SHAPES_PER_SIDE - 1];
-        cbottom = seite[0];
-        cshape = 2;
+    /* west_side is listed from bottom to top, east_side from top to bottom */
+    int top_down = seite == east_side;
+    result->top = sarr + seite[top_down ? 0 : SHAPES_PER_SIDE - 1];
+    result->bottom = sarr + seite[top_down ? SHAPES_PER_SIDE - 1 : 0];
+    for (size_t i = 0; i < SHAPES_PER_SIDE - 2; ++i) {
+        size_t cshape = top_down ? i : SHAPES_PER_SIDE - 3 - i;
+        result->fill[i] = sarr + seite[cshape + 1];
+        result->fill_lines[i] = iltf[cshape];
     }
+}
 
-    for (j = 0; j < sarr[ctop].height; ++j) {
-        result->chars[j] = sarr[ctop].chars[j];
-        result->mbcs[j] = sarr[ctop].mbcs[j];
-    }
-    for (j = 0; j < sarr[cbottom].height; ++j) {
-        result->chars[result->height - sarr[cbottom].height + j] = sarr[cbottom].chars[j];
-        result->mbcs[result->height - sarr[cbottom].height + j] = sarr[cbottom].mbcs[j];
-    }
 
-    sc = 0;
-    for (j = sarr[ctop].height; j < result->height - sarr[cbottom].height; ++j) {
-        while (iltf[cshape] == 0) {
-            if (seite == east_side) {
-                ++cshape;
-            } else {
-                --cshape;
-            }
-            sc = 0;
-        }
-        if (sc == sarr[seite[cshape + 1]].height) {
-            sc = 0;
+
+/**
+ * Find the shape line which makes up a given line of a vertical box side. This takes constant time, no matter how
+ * high the box is.
+ * @param side the box side
+ * @param j the index of the line, counted from the top of the box; must be less than the height of the side
+ * @param shape_line (OUT) the index of the line within the returned shape
+ * @return the shape which the line belongs to
+ */
+const sentry_t *vert_side_line(const vert_side_t *side, size_t j, size_t *shape_line)
+{
+    if (j < side->top->height) {
+        *shape_line = j;
+        return side->top;
+    }
+    size_t k = j - side->top->height;
+    for (size_t i = 0; i < SHAPES_PER_SIDE - 2; ++i) {
+        if (k < side->fill_lines[i]) {
+            *shape_line = k % side->fill[i]->height;
+            return side->fill[i];
         }
-        result->chars[j] = sarr[seite[cshape + 1]].chars[sc];
-        result->mbcs[j] = sarr[seite[cshape + 1]].mbcs[sc];
-        ++sc;
-        iltf[cshape] -= 1;
+        k -= side->fill_lines[i];
     }
+    *shape_line = k;
+    return side->bottom;
+}
+
+
+
+/**
+ * Get the line of a vertical box side as a string.
+ * @param side the box side
+ * @param j the index of the line, counted from the top of the box
+ * @return the line, which belongs to one of the shapes of the design
+ */
+static const bxstr_t *vert_side_mbcs(const vert_side_t *side, size_t j)
+{
+    size_t shape_line;
+    const sentry_t *shape = vert_side_line(side, j, &shape_line);
+    return shape->mbcs[shape_line];
 }
 
 
@@ -639,11 +563,11 @@ static int horiz_generate(sentry_t *tresult, sentry_t *bresult)
 
 
 
-static int vert_generate(sentry_t *lresult, sentry_t *rresult)
+static int vert_generate(vert_side_t *lresult, vert_side_t *rresult)
 /*
  *  Generate vertical sides of box.
  *
- *  RETURNS:  == 0   on success  (resulting char array is stored in [rl]result)
+ *  RETURNS:  == 0   on success  (resulting side descriptions are stored in [rl]result)
  *            != 0   on error
  *
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -684,41 +608,27 @@ static int vert_generate(sentry_t *lresult, sentry_t *rresult)
                 shape_name[east_side[3]], (int) rightiltf[2]);
     }
 
-    lresult->chars = (char **) calloc(lresult->height, sizeof(char *));
-    if (lresult->chars == NULL) {
-        return 1;
-    }
-    lresult->mbcs = (bxstr_t **) calloc(lresult->height, sizeof(bxstr_t *));
-    if (lresult->mbcs == NULL) {
-        return 1;
-    }
-    rresult->chars = (char **) calloc(rresult->height, sizeof(char *));
-    if (rresult->chars == NULL) {
-        return 1;
-    }
-    rresult->mbcs = (bxstr_t **) calloc(rresult->height, sizeof(bxstr_t *));
-    if (rresult->mbcs == NULL) {
-        return 1;
-    }
-
-    horiz_assemble(opt.design->shape, west_side, leftiltf, lresult);
-    horiz_assemble(opt.design->shape, east_side, rightiltf, rresult);
+    vert_side_init(opt.design->shape, west_side, leftiltf, lresult);
+    vert_side_init(opt.design->shape, east_side, rightiltf, rresult);
 
     /*
      *  Debugging code - Output left and right side of box
      */
     if (is_debug_logging(MAIN)) {
         size_t j;
+        size_t sl;
         log_debug(__FILE__, MAIN, "LEFT SIDE:\n");
         for (j = 0; j < lresult->height; ++j) {
-            char *out_sl = bxs_to_output(lresult->mbcs[j]);
-            log_debug(__FILE__, MAIN, "  %2d: \'%s\' - \'%s\'\n", (int) j, out_sl, lresult->chars[j]);
+            const sentry_t *shape = vert_side_line(lresult, j, &sl);
+            char *out_sl = bxs_to_output(shape->mbcs[sl]);
+            log_debug(__FILE__, MAIN, "  %2d: \'%s\' - \'%s\'\n", (int) j, out_sl, shape->chars[sl]);
             BFREE(out_sl);
         }
         log_debug(__FILE__, MAIN, "RIGHT SIDE:\n");
         for (j = 0; j < rresult->height; ++j) {
-            char *out_sl = bxs_to_output(rresult->mbcs[j]);
-            log_debug(__FILE__, MAIN, "  %2d: \'%s\' - \'%s\'\n", (int) j, out_sl, rresult->chars[j]);
+            const sentry_t *shape = vert_side_line(rresult, j, &sl);
+            char *out_sl = bxs_to_output(shape->mbcs[sl]);
+            log_debug(__FILE__, MAIN, "  %2d: \'%s\' - \'%s\'\n", (int) j, out_sl, shape->chars[sl]);
             BFREE(out_sl);
         }
     }
@@ -727,7 +637,7 @@ static int vert_generate(sentry_t *lresult, sentry_t *rresult)
 
 
 
-int generate_box(sentry_t *thebox)
+int generate_box(box_t *thebox)
 /*
  *
  *  RETURNS:  == 0  if successful  (thebox is set)
@@ -735,6 +645,13 @@ int generate_box(sentry_t *thebox)
  *
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  */
+{
+    return generate_box_reusing(thebox, NULL, NULL);
+}
+
+
+
+int generate_box_reusing(box_t *thebox, const box_t *horiz_from, const box_t *vert_from)
 {
     int rc;
     int i;
@@ -745,38 +662,56 @@ int generate_box(sentry_t *thebox)
         }
     }
 
-    rc = horiz_generate(&(thebox[0]), &(thebox[2]));
-    if (rc) {
-        goto err;
+    if (horiz_from != NULL) {
+        log_debug(__FILE__, MAIN, "Reusing top and bottom side of previous box.\n");
+        thebox->top = horiz_from->top;
+        thebox->bottom = horiz_from->bottom;
     }
-
-    rc = vert_generate(&(thebox[3]), &(thebox[1]));
-    if (rc) {
-        goto err;
+    else {
+        rc = horiz_generate(&(thebox->top), &(thebox->bottom));
+        if (rc) {
+            if (!isempty(&(thebox->top))) {
+                BFREE (thebox->top.chars);   /* free only pointer array */
+            }
+            if (!isempty(&(thebox->bottom))) {
+                BFREE (thebox->bottom.chars);
+            }
+            memset(thebox, 0, sizeof(box_t));
+            return rc;
+        }
     }
 
-    return 0;                            /* all clear */
-
-    err:
-    for (i = 0; i < NUM_SIDES; ++i) {
-        if (!isempty(&(thebox[i]))) {
-            BFREE (thebox[i].chars);     /* free only pointer array */
-            memset(thebox + i, 0, sizeof(sentry_t));
+    if (vert_from != NULL) {
+        log_debug(__FILE__, MAIN, "Reusing left and right side of previous box.\n");
+        thebox->left = vert_from->left;
+        thebox->right = vert_from->right;
+    }
+    else {
+        rc = vert_generate(&(thebox->left), &(thebox->right));
+        if (rc) {
+            if (horiz_from == NULL) {
+                BFREE (thebox->top.chars);
+                BFREE (thebox->bottom.chars);
+            }
+            memset(thebox, 0, sizeof(box_t));
+            return rc;
         }
     }
-    return rc;                           /* error */
+
+    return 0;                            /* all clear */
 }
 
 
 
-static int justify_line(line_t *line, int skew)
+static int justify_line(const line_t *line, int skew)
 /*
  *  Justify input line according to specified justification
  *
  *     line   line to justify
  *     skew   difference in spaces right/left of text block (hpr-hpl)
  *
- *  line is assumed to be already free of trailing whitespace.
+ *  line is assumed to be already free of trailing whitespace. It is not
+ *  modified, and nothing is allocated, except for debug output.
  *
  *  RETURNS:  number of space characters which must be added to (> 0)
  *            or removed from (< 0) the beginning of the line
@@ -852,77 +787,747 @@ static int justify_line(line_t *line, int skew)
 
 
 
-int output_box(const sentry_t *thebox)
-/*
- *  Generate final output using the previously generated box parts.
- *
- *    thebox    Array of four shapes which contain the previously generated
- *              box parts in the following order: BTOP, BRIG, BBOT, BLEF
- *
- *  RETURNS:  == 0  if successful
- *            != 0  on error
- *
-* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+/**
+ * One line of output, which is composed from its parts before it is written. The buffers are reused for all lines.
  */
-{
-    size_t j;
-    size_t nol = thebox[BRIG].height;   /* number of output lines */
-    size_t vfill, vfill1, vfill2;       /* empty lines/columns in box */
-    size_t hfill;
-    uint32_t *hfill1, *hfill2;          /* space before/after text */
-    size_t hpl, hpr;
-    size_t skip_start;                  /* lines to skip for box top */
-    size_t skip_end;                    /* lines to skip for box bottom */
-    size_t skip_left;                   /* true if left box part is to be skipped */
-    size_t ntabs, nspcs;                /* needed for unexpand of tabs */
+typedef struct {
+    /** the line being composed, as UTF-32 codepoints */
+    uint32_t *memory;
 
-    log_debug(__FILE__, MAIN, "Padding used: left %d, top %d, right %d, bottom %d\n",
-        opt.design->padding[BLEF], opt.design->padding[BTOP],
-        opt.design->padding[BRIG], opt.design->padding[BBOT]);
+    /** number of codepoints in `memory`, not counting the terminating NUL; or number of bytes in `out` if `bytes` */
+    size_t len;
 
-    /*
-     *  Create string of spaces for indentation
-     */
-    uint32_t *indentspc = NULL;
-    size_t indentspclen = 0;
-    ntabs = nspcs = 0;
-    if (opt.design->indentmode == 'b') {
-        if (opt.tabexp == 'u') {
-            ntabs = input.indent / opt.tabstop;
-            nspcs = input.indent % opt.tabstop;
-            indentspclen = ntabs + nspcs;
-        }
-        else {
-            indentspclen = input.indent;
-        }
+    /** allocated size of `memory` in codepoints */
+    size_t size;
 
-        indentspc = (uint32_t *) malloc((indentspclen + 1) * sizeof(uint32_t));
-        if (indentspc == NULL) {
+    /** the line converted to the output encoding, or the line being composed if `bytes` is set */
+    char *out;
+
+    /** allocated size of `out` in bytes */
+    size_t out_size;
+
+    /** flag indicating that the line is composed directly in `out`, because the box and the text are pure ASCII */
+    int bytes;
+
+    /** flag indicating that finished lines are collected in `collected` instead of being written to the output file */
+    int collect;
+
+    /** the finished lines in the output encoding, including line breaks, if `collect` is set */
+    char *collected;
+
+    /** number of bytes in `collected` */
+    size_t collected_len;
+
+    /** allocated size of `collected` in bytes */
+    size_t collected_size;
+} output_line_t;
+
+
+
+/**
+ * Make sure the output encoding buffer of the line has room for `n` bytes.
+ * @param line the line being composed
+ * @param n the number of bytes needed
+ * @return == 0 on success; != 0 if out of memory
+ */
+static int line_reserve_out(output_line_t *line, size_t n)
+{
+    if (n > line->out_size) {
+        size_t new_size = BMAX(2 * line->out_size, n);
+        char *new_out = (char *) realloc(line->out, new_size);
+        if (new_out == NULL) {
             perror(PROJECT);
             return 1;
         }
+        line->out = new_out;
+        line->out_size = new_size;
+    }
+    return 0;
+}
 
-        if (opt.tabexp == 'u') {
-            u32_set(indentspc, char_tab, ntabs);
-            u32_set(indentspc + ntabs, char_space, nspcs);
-        }
-        else {
-            u32_set(indentspc, char_space, indentspclen);
+
+
+/**
+ * Make sure the line has room for `n` more codepoints plus a terminating NUL.
+ * @param line the line being composed
+ * @param n the number of codepoints to be appended
+ * @return == 0 on success; != 0 if out of memory
+ */
+static int line_reserve(output_line_t *line, size_t n)
+{
+    if (line->bytes) {
+        return line_reserve_out(line, line->len + n + 1);
+    }
+    if (line->len + n + 1 > line->size) {
+        size_t new_size = BMAX(2 * line->size, line->len + n + 1);
+        uint32_t *new_memory = (uint32_t *) realloc(line->memory, new_size * sizeof(uint32_t));
+        if (new_memory == NULL) {
+            perror(PROJECT);
+            return 1;
+        }
+        line->memory = new_memory;
+        line->size = new_size;
+    }
+    return 0;
+}
+
+
+
+static int line_append(output_line_t *line, const uint32_t *s, size_t n)
+{
+    if (line_reserve(line, n)) {
+        return 1;
+    }
+    if (line->bytes) {
+        for (size_t i = 0; i < n; i++) {
+            line->out[line->len + i] = (char) s[i];
         }
-        set_char_at(indentspc, indentspclen, char_nul);
     }
     else {
-        indentspc = new_empty_string32();
-        if (indentspc == NULL) {
+        memcpy(line->memory + line->len, s, n * sizeof(uint32_t));
+    }
+    line->len += n;
+    return 0;
+}
+
+
+
+static int line_append_spaces(output_line_t *line, size_t n)
+{
+    if (line_reserve(line, n)) {
+        return 1;
+    }
+    if (line->bytes) {
+        memset(line->out + line->len, ' ', n);
+    }
+    else {
+        u32_set(line->memory + line->len, char_space, n);
+    }
+    line->len += n;
+    return 0;
+}
+
+
+
+/**
+ * Append a string, starting at the given character. In a pure ASCII line, the string is pure ASCII, too, so its
+ * `ascii` version can be copied as it is.
+ * @param line the line being composed
+ * @param s the string to append
+ * @param from index into the `memory` of the string of the first character to append
+ * @return == 0 on success; != 0 if out of memory
+ */
+static int line_append_bxs_from(output_line_t *line, const bxstr_t *s, size_t from)
+{
+    if (!line->bytes) {
+        return line_append(line, s->memory + from, s->num_chars - from);
+    }
+    if (line_reserve(line, s->num_chars - from)) {
+        return 1;
+    }
+    memcpy(line->out + line->len, s->ascii + from, s->num_chars - from);
+    line->len += s->num_chars - from;
+    return 0;
+}
+
+
+
+static int line_append_bxs(output_line_t *line, const bxstr_t *s)
+{
+    return line_append_bxs_from(line, s, 0);
+}
+
+
+
+/**
+ * Append the indentation of the box. If tabs are kept (`-t nk`), they are restored according to the given input line.
+ * @param line the line being composed
+ * @param lineno index of the input line whose tabs to restore
+ * @param indentspc the indentation of the box as calculated by `output_box()`
+ * @param indentspclen the length of `indentspc`
+ * @return == 0 on success; != 0 if out of memory
+ */
+static int line_append_indent(output_line_t *line, size_t lineno, const uint32_t *indentspc, size_t indentspclen)
+{
+    if (opt.tabexp != 'k') {
+        return line_append(line, indentspc, indentspclen);
+    }
+    if (lineno >= input.num_lines || line_reserve(line, indentspclen)) {
+        return lineno >= input.num_lines ? 0 : 1;
+    }
+    line->len += tabbify_indent_to(lineno, indentspclen, line->memory + line->len);
+    return 0;
+}
+
+
+
+/**
+ * Write bytes to the output file, or collect them if the line is set up to collect its output.
+ * @param line the line being composed
+ * @param bytes the bytes to write
+ * @param n the number of bytes
+ * @return == 0 on success; != 0 if out of memory
+ */
+static int line_write(output_line_t *line, const char *bytes, size_t n)
+{
+    if (!line->collect) {
+        fwrite(bytes, 1, n, opt.outfile);
+        return 0;
+    }
+    if (line->collected_len + n > line->collected_size) {
+        size_t new_size = BMAX(2 * line->collected_size, line->collected_len + n);
+        char *new_collected = (char *) realloc(line->collected, new_size);
+        if (new_collected == NULL) {
             perror(PROJECT);
             return 1;
         }
+        line->collected = new_collected;
+        line->collected_size = new_size;
+    }
+    memcpy(line->collected + line->collected_len, bytes, n);
+    line->collected_len += n;
+    return 0;
+}
+
+
+
+/**
+ * Remove trailing blanks from a pure ASCII line, the same way as `bxs_rtrim_raw()`. A line consisting only of blanks
+ * is left as it is.
+ * @param s the line
+ * @param len the number of bytes in the line
+ * @return the new length of the line
+ */
+static size_t rtrim_ascii(const char *s, size_t len)
+{
+    size_t result = len;
+    while (result > 0 && (s[result - 1] == ' ' || s[result - 1] == '\t')) {
+        result--;
+    }
+    return result > 0 ? result : len;
+}
+
+
+
+/**
+ * Write the composed line to the output file, with trailing blanks removed, and start a new line.
+ * @param line the line being composed; its contents are consumed
+ * @param eol the line break to print after the line
+ * @return == 0 on success; != 0 if out of memory
+ */
+static int line_flush(output_line_t *line, const char *eol)
+{
+    int rc = 0;
+    if (line->bytes) {
+        rc = line_write(line, line->out, rtrim_ascii(line->out, line->len));
+    }
+    else {
+        rc = line_reserve(line, 0);
+        if (rc == 0) {
+            set_char_at(line->memory, line->len, char_nul);
+            line->len = bxs_rtrim_raw(line->memory, !color_output_enabled);
+            size_t out_len = u32_conv_to_output_buf(line->memory, line->len, &(line->out), &(line->out_size));
+            if (out_len != (size_t) -1) {
+                rc = line_write(line, line->out, out_len);
+            }
+        }
+    }
+    line->len = 0;
+    return rc || line_write(line, eol, strlen(eol));
+}
+
+
+
+/**
+ * Everything needed to compose any line of the box, as calculated by `output_box()`.
+ */
+typedef struct {
+    /** the generated sides of the box */
+    const box_t *thebox;
+
+    /** number of output lines, including the lines to skip */
+    size_t nol;
+
+    /** number of lines to skip at the bottom because the bottom side is empty */
+    size_t skip_end;
+
+    /** flag indicating that the left side is to be skipped because it is empty */
+    size_t skip_left;
+
+    /** number of empty lines in the box above the text, including padding */
+    size_t vfill1;
+
+    /** number of empty lines in the box, including padding */
+    size_t vfill;
+
+    /** number of empty lines in the box below the text, including padding */
+    size_t vfill2;
+
+    /** spaces before the text, `hpl` of which are used */
+    const uint32_t *hfill1;
+    size_t hpl;
+
+    /** spaces after the text, `hpr` of which are used */
+    const uint32_t *hfill2;
+    size_t hpr;
+
+    /** the indentation of the box */
+    const uint32_t *indentspc;
+    size_t indentspclen;
+
+    /** flag indicating that the lines are composed as byte strings, see `is_pure_ascii_box()` */
+    int bytes;
+
+    /** if the box has simple sides, the start of every text line up to the text, in the output encoding; else NULL */
+    char *text_prefix;
+    size_t text_prefix_len;
+
+    /** if the box has simple sides, the right side of every text line, in the output encoding */
+    char *text_suffix;
+    size_t text_suffix_len;
+} box_layout_t;
+
+
+
+/**
+ * Determine the line terminator of an output line.
+ * @param layout the layout of the box
+ * @param j index of the output line, counted from the top of the box
+ * @return the line break to print after the line, which is empty after the last line if the input had none
+ */
+static const char *row_eol(const box_layout_t *layout, size_t j)
+{
+    return input.final_newline || j < layout->nol - layout->skip_end - 1 ? opt.eol : "";
+}
+
+
+
+/**
+ * Compose a line of text of a box with simple sides, and pass it on to `line_write()`. Such a line consists of the
+ * constant `text_prefix` and `text_suffix` of the layout with the text and its fill in between, so only the text must
+ * be converted to the output encoding. There are no trailing blanks to remove, because the right side ends in a
+ * visible character.
+ * @param layout the layout of the box, which must have a `text_prefix`
+ * @param text the input line
+ * @param shift the number of spaces to add to (> 0) or remove from (< 0) the beginning of the input line
+ * @param line the line being composed, whose `out` buffer is used
+ * @param eol the line break to print after the line
+ * @return == 0 on success; != 0 on error; -1 if the line cannot be composed this way, so nothing was written
+ */
+static int output_simple_text_row(const box_layout_t *layout, bxstr_t *text, int shift, output_line_t *line,
+        const char *eol)
+{
+    const uint32_t *text_shifted = shift < 0 ? bxs_first_char_ptr(text, (size_t) (-shift)) : text->memory;
+    size_t text_len = text->num_chars - (size_t) (text_shifted - text->memory);
+    size_t spaces_before = shift > 0 ? (size_t) shift : 0;
+    size_t spaces_after = layout->hpr + input.maxline - text->num_columns - shift;
+    size_t text_size = 4 * text_len;        /* UTF-8 needs at most four bytes per codepoint */
+    size_t eol_len = strlen(eol);
+    if (line_reserve_out(line, layout->text_prefix_len + spaces_before + text_size + spaces_after
+            + layout->text_suffix_len + eol_len)) {
+        return 1;
+    }
+
+    char *p = line->out;
+    memcpy(p, layout->text_prefix, layout->text_prefix_len);
+    p += layout->text_prefix_len;
+    memset(p, ' ', spaces_before);
+    p += spaces_before;
+    if (line->bytes) {
+        memcpy(p, text->ascii + (text_shifted - text->memory), text_len);
+        text_size = text_len;
+    }
+    else {
+        uint8_t *u8 = u32_to_u8(text_shifted, text_len, (uint8_t *) p, &text_size);
+        if (u8 != (uint8_t *) p) {
+            /* not valid Unicode, which the general path replaces with question marks */
+            BFREE(u8);
+            return -1;
+        }
+    }
+    p += text_size;
+    memset(p, ' ', spaces_after);
+    p += spaces_after;
+    memcpy(p, layout->text_suffix, layout->text_suffix_len);
+    p += layout->text_suffix_len;
+    memcpy(p, eol, eol_len);
+    p += eol_len;
+    return line_write(line, line->out, (size_t) (p - line->out));
+}
+
+
+
+/**
+ * Compose one line of the box and pass it on to `line_flush()`. Every line depends only on the layout and on its own
+ * input line, so the lines can be composed in any order.
+ * @param layout the layout of the box
+ * @param j index of the output line, counted from the top of the box
+ * @param line the line being composed
+ * @return == 0 on success; != 0 on error
+ */
+static int output_row(const box_layout_t *layout, size_t j, output_line_t *line)
+{
+    const box_t *thebox = layout->thebox;
+    size_t nol = layout->nol;
+    int rc;
+
+    if (j < thebox->top.height) {    /* box top */
+        rc = line_append_indent(line, 0, layout->indentspc, layout->indentspclen)
+            || (!layout->skip_left && line_append_bxs(line, vert_side_mbcs(&(thebox->left), j)))
+            || line_append_bxs(line, thebox->top.mbcs[j])
+            || line_append_bxs(line, vert_side_mbcs(&(thebox->right), j));
+    }
+
+    else if (j < thebox->top.height + layout->vfill1) {  /* top vfill */
+        rc = line_append_indent(line, 0, layout->indentspc, layout->indentspclen)
+            || (!layout->skip_left && line_append_bxs(line, vert_side_mbcs(&(thebox->left), j)))
+            || line_append_spaces(line, thebox->top.width)
+            || line_append_bxs(line, vert_side_mbcs(&(thebox->right), j));
+    }
+
+    else if (j < nol - thebox->bottom.height) {
+        long ti = j - thebox->top.height - (layout->vfill - layout->vfill2);
+        if (ti < (long) input.num_lines) {      /* box content (lines) */
+            int shift = justify_line(input.lines + ti, layout->hpr - layout->hpl);
+            bxstr_t *text = input.lines[ti].text;
+            if (layout->text_prefix != NULL && (color_output_enabled || text->num_chars_invisible == 0)) {
+                rc = output_simple_text_row(layout, text, shift, line, row_eol(layout, j));
+                if (rc >= 0) {
+                    return rc;
+                }
+            }
+            const uint32_t *text_shifted = shift < 0 ? bxs_first_char_ptr(text, (size_t) (-shift)) : text->memory;
+            rc = line_append_indent(line, ti, layout->indentspc, layout->indentspclen)
+                || (!layout->skip_left && line_append_bxs(line, vert_side_mbcs(&(thebox->left), j)))
+                || line_append(line, layout->hfill1, layout->hpl)
+                || line_append_spaces(line, shift > 0 ? (size_t) shift : 0)
+                || line_append_bxs_from(line, text, (size_t) (text_shifted - text->memory))
+                || line_append(line, layout->hfill2, layout->hpr)
+                || line_append_spaces(line, input.maxline - input.lines[ti].text->num_columns - shift)
+                || line_append_bxs(line, vert_side_mbcs(&(thebox->right), j));
+        }
+        else {                       /* bottom vfill */
+            rc = line_append_indent(line, input.num_lines - 1, layout->indentspc, layout->indentspclen)
+                || (!layout->skip_left && line_append_bxs(line, vert_side_mbcs(&(thebox->left), j)))
+                || line_append_spaces(line, thebox->top.width)
+                || line_append_bxs(line, vert_side_mbcs(&(thebox->right), j));
+        }
+    }
+
+    else {                           /* box bottom */
+        rc = line_append_indent(line, input.num_lines - 1, layout->indentspc, layout->indentspclen)
+            || (!layout->skip_left && line_append_bxs(line, vert_side_mbcs(&(thebox->left), j)))
+            || line_append_bxs(line, thebox->bottom.mbcs[j - (nol - thebox->bottom.height)])
+            || line_append_bxs(line, vert_side_mbcs(&(thebox->right), j));
+    }
+
+    if (rc == 0) {
+        rc = line_flush(line, row_eol(layout, j));
+    }
+    return rc;
+}
+
+
+
+static int is_ascii_bxs(const bxstr_t *s)
+{
+    for (const uint32_t *c = s->memory; *c != char_nul; c++) {
+        if (!is_ascii_printable(*c)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+static int is_ascii_shape(const sentry_t *shape)
+{
+    for (size_t i = 0; i < shape->height; i++) {
+        if (!is_ascii_bxs(shape->mbcs[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+/**
+ * Determine if the lines of the box can be composed as byte strings, without UTF-32. This is the case when the design
+ * and the text consist only of printable ASCII characters, and the output encoding represents them as they are. The
+ * strings can then be copied from their `ascii` versions. Tabs must not be kept (`-t k`), because they are restored
+ * in UTF-32.
+ * @param thebox the generated sides of the box
+ * @return flag (1 or 0)
+ */
+static int is_pure_ascii_box(const box_t *thebox)
+{
+    if (getenv(GENERAL_COMPOSER_ENV) != NULL || opt.tabexp == 'k' || !is_ascii_superset(encoding)
+            || !is_ascii_shape(&(thebox->top)) || !is_ascii_shape(&(thebox->bottom))) {
+        return 0;
+    }
+    for (size_t i = 0; i < NUM_SHAPES; i++) {
+        if (!is_ascii_shape(opt.design->shape + i)) {
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < input.num_lines; i++) {
+        if (!is_ascii_bxs(input.lines[i].text)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+/**
+ * Find the line which a vertical box side shows next to every line of text, if it is the same for all of them. This
+ * is the case when the middle part of the side is made of a single one-line shape, as in the C comment designs.
+ * @param side the box side
+ * @return that line, or NULL if the side shows different lines next to the text
+ */
+static const bxstr_t *constant_side_line(const vert_side_t *side)
+{
+    const sentry_t *result = NULL;
+    for (size_t i = 0; i < SHAPES_PER_SIDE - 2; ++i) {
+        if (side->fill_lines[i] > 0) {
+            if (result != NULL || side->fill[i]->height != 1) {
+                return NULL;
+            }
+            result = side->fill[i];
+        }
+    }
+    return result != NULL ? result->mbcs[0] : NULL;
+}
+
+
+
+/**
+ * Check if the box has simple sides, and if so, set up the `text_prefix` and `text_suffix` of the layout, which let
+ * `output_simple_text_row()` compose the lines of text. The sides are simple if they show the same line next to every
+ * line of text, and the right side ends in a visible character, so that no trailing blanks must be removed. The output
+ * encoding must be UTF-8, unless the lines are composed as byte strings, and tabs must not be kept, because they would
+ * make the indentation differ between lines.
+ * @param layout the layout of the box, whose other fields are already set
+ * @return == 0 on success, which includes the case that the sides are not simple; != 0 if out of memory
+ */
+static int simple_sides_init(box_layout_t *layout)
+{
+    layout->text_prefix = NULL;
+    layout->text_suffix = NULL;
+    if (getenv(GENERAL_COMPOSER_ENV) != NULL || (strcasecmp(encoding, "UTF-8") != 0 && !layout->bytes)
+            || opt.tabexp == 'k') {
+        return 0;
+    }
+    const bxstr_t *left = layout->skip_left ? NULL : constant_side_line(&(layout->thebox->left));
+    const bxstr_t *right = constant_side_line(&(layout->thebox->right));
+    if ((left == NULL && !layout->skip_left) || right == NULL || right->num_chars_visible == 0
+            || right->num_chars_invisible > 0 || right->trailing > 0
+            || (left != NULL && left->num_chars_invisible > 0)) {
+        return 0;
+    }
+
+    output_line_t prefix;
+    memset(&prefix, 0, sizeof(output_line_t));
+    int rc = line_append(&prefix, layout->indentspc, layout->indentspclen)
+        || (left != NULL && line_append_bxs(&prefix, left))
+        || line_append(&prefix, layout->hfill1, layout->hpl)
+        || line_reserve(&prefix, 0);
+    if (rc == 0) {
+        set_char_at(prefix.memory, prefix.len, char_nul);
+        layout->text_prefix = u32_strconv_to_output(prefix.memory);
+        layout->text_suffix = u32_strconv_to_output(right->memory);
+        if (layout->text_prefix == NULL || layout->text_suffix == NULL) {
+            BFREE(layout->text_prefix);
+            BFREE(layout->text_suffix);
+            rc = 1;
+        }
+        else {
+            layout->text_prefix_len = strlen(layout->text_prefix);
+            layout->text_suffix_len = strlen(layout->text_suffix);
+            log_debug(__FILE__, MAIN, "Simple sides, text lines are composed as \"%s\" + text + \"%s\"\n",
+                    layout->text_prefix, layout->text_suffix);
+        }
+    }
+    BFREE(prefix.memory);
+    return rc;
+}
+
+
+
+/** a range of output lines to be composed, possibly by a worker thread */
+typedef struct {
+    /** the layout of the box */
+    const box_layout_t *layout;
+
+    /** index of the first output line of the range */
+    size_t from;
+
+    /** index of the output line following the range */
+    size_t to;
+
+    /** the line being composed, which collects the finished lines of the range if composed by a worker thread */
+    output_line_t line;
+
+    /** (OUT) the result of composing the range, == 0 on success */
+    int rc;
+} row_range_t;
+
+
+
+static int output_row_range(row_range_t *range)
+{
+    range->rc = 0;
+    for (size_t j = range->from; j < range->to && range->rc == 0; ++j) {
+        range->rc = output_row(range->layout, j, &(range->line));
+    }
+    return range->rc;
+}
+
+
+
+#ifndef __MINGW32__
+
+static void *output_row_range_thread(void *arg)
+{
+    output_row_range((row_range_t *) arg);
+    return NULL;
+}
+
+
+
+/**
+ * Compose the given output lines using worker threads. The lines are processed in rounds, so that the memory needed
+ * for collecting them stays bounded. In each round, every thread composes a contiguous chunk of lines into its own
+ * buffer, and the buffers are then written in order, so that the output is the same as when composing serially.
+ * @param layout the layout of the box
+ * @param from index of the first output line to compose
+ * @param to index of the output line following the last one to compose
+ * @param num_threads the number of threads to use
+ * @return == 0 on success; != 0 on error
+ */
+static int output_rows_parallel(const box_layout_t *layout, size_t from, size_t to, size_t num_threads)
+{
+    pthread_t threads[MAX_ROW_THREADS];
+    int started[MAX_ROW_THREADS];
+    row_range_t chunks[MAX_ROW_THREADS];
+    memset(chunks, 0, sizeof(chunks));
+    for (size_t t = 0; t < num_threads; t++) {
+        chunks[t].layout = layout;
+        chunks[t].line.bytes = layout->bytes;
+        chunks[t].line.collect = 1;
+    }
+
+    int rc = 0;
+    size_t chunk_size = MAX_ROWS_PER_CHUNK;
+    while (from < to && rc == 0) {
+        size_t round_end = BMIN(to, from + num_threads * chunk_size);
+        size_t round_chunk_size = (round_end - from + num_threads - 1) / num_threads;
+        for (size_t t = 0; t < num_threads; t++) {
+            chunks[t].from = BMIN(from + t * round_chunk_size, round_end);
+            chunks[t].to = BMIN(chunks[t].from + round_chunk_size, round_end);
+            chunks[t].line.collected_len = 0;
+            started[t] = pthread_create(threads + t, NULL, output_row_range_thread, chunks + t) == 0;
+            if (!started[t]) {
+                output_row_range(chunks + t);
+            }
+        }
+        for (size_t t = 0; t < num_threads; t++) {
+            if (started[t]) {
+                pthread_join(threads[t], NULL);
+            }
+        }
+        for (size_t t = 0; t < num_threads && rc == 0; t++) {
+            fwrite(chunks[t].line.collected, 1, chunks[t].line.collected_len, opt.outfile);
+            rc = chunks[t].rc;
+        }
+        from = round_end;
+    }
+
+    for (size_t t = 0; t < num_threads; t++) {
+        BFREE(chunks[t].line.memory);
+        BFREE(chunks[t].line.out);
+        BFREE(chunks[t].line.collected);
     }
+    return rc;
+}
+
+#endif
+
+
+
+/**
+ * Compose the given output lines and write them to the output file. For large boxes, the lines are composed by worker
+ * threads.
+ * @param layout the layout of the box
+ * @param from index of the first output line to compose
+ * @param to index of the output line following the last one to compose
+ * @return == 0 on success; != 0 on error
+ */
+static int output_rows(const box_layout_t *layout, size_t from, size_t to)
+{
+    #ifndef __MINGW32__
+        size_t num_threads = num_worker_threads(to - from, MIN_ROWS_PER_THREAD, MAX_ROW_THREADS);
+        if (num_threads > 1) {
+            return output_rows_parallel(layout, from, to, num_threads);
+        }
+    #endif
+    row_range_t range;
+    memset(&range, 0, sizeof(row_range_t));
+    range.layout = layout;
+    range.from = from;
+    range.to = to;
+    range.line.bytes = layout->bytes;
+    int rc = output_row_range(&range);
+    BFREE(range.line.memory);
+    BFREE(range.line.out);
+    return rc;
+}
+
+
+
+/**
+ * The space around the text block inside a box, as determined by the alignment of the text and the padding.
+ */
+typedef struct {
+    /** number of empty lines in the box, including padding */
+    size_t vfill;
+
+    /** number of empty lines above the text, including padding */
+    size_t vfill1;
+
+    /** number of empty lines below the text, including padding */
+    size_t vfill2;
+
+    /** number of columns in the box not taken by the text, including padding */
+    size_t hfill;
+
+    /** number of columns left of the text, including padding */
+    size_t hpl;
+
+    /** number of columns right of the text, including padding */
+    size_t hpr;
+} text_fill_t;
+
+
+
+/**
+ * Work out where the text block goes inside the box, according to the alignment of the text and the padding.
+ * @param inner_width width of the box without the left and right sides
+ * @param inner_height height of the box without the top and bottom sides
+ * @param result (OUT) the space around the text block
+ */
+static void text_fill(size_t inner_width, size_t inner_height, text_fill_t *result)
+{
+    size_t vfill, vfill1, vfill2;
+    size_t hfill, hpl, hpr;
 
     /*
      *  Compute number of empty lines in box (vfill).
      */
-    vfill = nol - thebox[BTOP].height - thebox[BBOT].height - input.num_lines;
+    vfill = inner_height - input.num_lines;
     vfill -= opt.design->padding[BTOP] + opt.design->padding[BBOT];
     if (opt.valign == 'c') {
         vfill1 = vfill / 2;
@@ -941,19 +1546,9 @@ int output_box(const sentry_t *thebox)
     vfill += opt.design->padding[BTOP] + opt.design->padding[BBOT];
 
     /*
-     *  Provide strings for horizontal text alignment.
+     *  Compute number of empty columns left and right of the text.
      */
-    hfill = thebox[BTOP].width - input.maxline;
-    hfill1 = (uint32_t *) malloc((hfill + 1) * sizeof(uint32_t));
-    hfill2 = (uint32_t *) malloc((hfill + 1) * sizeof(uint32_t));
-    if (!hfill1 || !hfill2) {
-        perror(PROJECT);
-        return 1;
-    }
-    u32_set(hfill1, char_space, hfill);
-    u32_set(hfill2, char_space, hfill);
-    set_char_at(hfill1, hfill, char_nul);
-    set_char_at(hfill2, hfill, char_nul);
+    hfill = inner_width - input.maxline;
     hpl = 0;
     hpr = 0;
     if (hfill == 1) {
@@ -983,6 +1578,103 @@ int output_box(const sentry_t *thebox)
         }
         hfill += opt.design->padding[BLEF] + opt.design->padding[BRIG];
     }
+
+    result->vfill = vfill;
+    result->vfill1 = vfill1;
+    result->vfill2 = vfill2;
+    result->hfill = hfill;
+    result->hpl = hpl;
+    result->hpr = hpr;
+}
+
+
+
+int output_box(const box_t *thebox)
+/*
+ *  Generate final output using the previously generated box parts.
+ *
+ *    thebox    the previously generated box parts
+ *
+ *  RETURNS:  == 0  if successful
+ *            != 0  on error
+ *
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ */
+{
+    size_t nol = thebox->right.height;   /* number of output lines */
+    size_t vfill, vfill1, vfill2;       /* empty lines/columns in box */
+    size_t hfill;
+    uint32_t *hfill1, *hfill2;          /* space before/after text */
+    size_t hpl, hpr;
+    size_t skip_start;                  /* lines to skip for box top */
+    size_t skip_end;                    /* lines to skip for box bottom */
+    size_t skip_left;                   /* true if left box part is to be skipped */
+    size_t ntabs, nspcs;                /* needed for unexpand of tabs */
+
+    log_debug(__FILE__, MAIN, "Padding used: left %d, top %d, right %d, bottom %d\n",
+        opt.design->padding[BLEF], opt.design->padding[BTOP],
+        opt.design->padding[BRIG], opt.design->padding[BBOT]);
+
+    /*
+     *  Create string of spaces for indentation
+     */
+    uint32_t *indentspc = NULL;
+    size_t indentspclen = 0;
+    ntabs = nspcs = 0;
+    if (opt.design->indentmode == 'b') {
+        if (opt.tabexp == 'u') {
+            ntabs = input.indent / opt.tabstop;
+            nspcs = input.indent % opt.tabstop;
+            indentspclen = ntabs + nspcs;
+        }
+        else {
+            indentspclen = input.indent;
+        }
+
+        indentspc = (uint32_t *) malloc((indentspclen + 1) * sizeof(uint32_t));
+        if (indentspc == NULL) {
+            perror(PROJECT);
+            return 1;
+        }
+
+        if (opt.tabexp == 'u') {
+            u32_set(indentspc, char_tab, ntabs);
+            u32_set(indentspc + ntabs, char_space, nspcs);
+        }
+        else {
+            u32_set(indentspc, char_space, indentspclen);
+        }
+        set_char_at(indentspc, indentspclen, char_nul);
+    }
+    else {
+        indentspc = new_empty_string32();
+        if (indentspc == NULL) {
+            perror(PROJECT);
+            return 1;
+        }
+    }
+
+    /*
+     *  Compute the empty lines and columns around the text, and provide strings for horizontal text alignment.
+     */
+    text_fill_t fill;
+    text_fill(thebox->top.width, nol - thebox->top.height - thebox->bottom.height, &fill);
+    vfill = fill.vfill;
+    vfill1 = fill.vfill1;
+    vfill2 = fill.vfill2;
+    hfill = fill.hfill;
+    hpl = fill.hpl;
+    hpr = fill.hpr;
+    hfill1 = (uint32_t *) malloc((hfill + 1) * sizeof(uint32_t));
+    hfill2 = (uint32_t *) malloc((hfill + 1) * sizeof(uint32_t));
+    if (!hfill1 || !hfill2) {
+        perror(PROJECT);
+        return 1;
+    }
+    u32_set(hfill1, char_space, hfill);
+    u32_set(hfill2, char_space, hfill);
+    set_char_at(hfill1, hfill, char_nul);
+    set_char_at(hfill2, hfill, char_nul);
     set_char_at(hfill1, hpl, char_nul);
     set_char_at(hfill2, hpr, char_nul);
 
@@ -1021,88 +1713,65 @@ int output_box(const sentry_t *thebox)
     /*
      *  Generate actual output
      */
-    bxstr_t *obuf = NULL;           /* final output string */
-    uint32_t *restored_indent;
-    uint32_t *empty_string = new_empty_string32();
-    for (j = skip_start; j < nol - skip_end; ++j) {
-
-        if (j < thebox[BTOP].height) {   /* box top */
-            restored_indent = tabbify_indent(0, indentspc, indentspclen);
-            obuf = bxs_concat(4, restored_indent, 
-                            skip_left ? empty_string : thebox[BLEF].mbcs[j]->memory,
-                            thebox[BTOP].mbcs[j]->memory,
-                            thebox[BRIG].mbcs[j]->memory);
-        }
+    box_layout_t layout = {thebox, nol, skip_end, skip_left, vfill1, vfill, vfill2, hfill1, hpl, hfill2, hpr,
+            indentspc, indentspclen, is_pure_ascii_box(thebox), NULL, 0, NULL, 0};
+    log_debug(__FILE__, MAIN, "Lines are composed as %s.\n", layout.bytes ? "byte strings" : "UTF-32");
+    int rc = simple_sides_init(&layout);
+    if (rc == 0) {
+        rc = output_rows(&layout, skip_start, nol - skip_end);
+    }
 
-        else if (vfill1) {               /* top vfill */
-            restored_indent = tabbify_indent(0, indentspc, indentspclen);
-            uint32_t *wspc = u32_nspaces(thebox[BTOP].width);
-            obuf = bxs_concat(4, restored_indent,
-                            skip_left ? empty_string : thebox[BLEF].mbcs[j]->memory,
-                            wspc,
-                            thebox[BRIG].mbcs[j]->memory);
-            --vfill1;
-            BFREE(wspc);
-        }
+    BFREE (layout.text_prefix);
+    BFREE (layout.text_suffix);
+    BFREE (indentspc);
+    BFREE (hfill1);
+    BFREE (hfill2);
+    return rc;
+}
 
-        else if (j < nol - thebox[BBOT].height) {
-            long ti = j - thebox[BTOP].height - (vfill - vfill2);
-            if (ti < (long) input.num_lines) {      /* box content (lines) */
-                int shift = justify_line(input.lines + ti, hpr - hpl);
-                restored_indent = tabbify_indent(ti, indentspc, indentspclen);
-                bxstr_t *text_shifted = bxs_cut_front(input.lines[ti].text, shift < 0 ? (size_t) (-shift) : 0);
-                uint32_t *spc1 = empty_string;
-                if (ti >= 0 && shift > 0) {
-                    spc1 = u32_nspaces(shift);
-                }
-                uint32_t *spc2 = u32_nspaces(input.maxline - input.lines[ti].text->num_columns - shift);
-                obuf = bxs_concat(8, restored_indent,
-                                skip_left ? empty_string : thebox[BLEF].mbcs[j]->memory, hfill1, spc1,
-                                ti >= 0 ? text_shifted->memory : empty_string, hfill2, spc2,
-                                thebox[BRIG].mbcs[j]->memory);
-                bxs_free(text_shifted);
-                if (spc1 != empty_string) {
-                    BFREE(spc1);
-                }
-                BFREE(spc2);
-            }
-            else {                       /* bottom vfill */
-                restored_indent = tabbify_indent(input.num_lines - 1, indentspc, indentspclen);
-                uint32_t *spc = u32_nspaces(thebox[BTOP].width);
-                obuf = bxs_concat(4, restored_indent,
-                                skip_left ? empty_string : thebox[BLEF].mbcs[j]->memory,
-                                spc,
-                                thebox[BRIG].mbcs[j]->memory);
-                BFREE(spc);
-            }
-        }
 
-        else {                           /* box bottom */
-            restored_indent = tabbify_indent(input.num_lines - 1, indentspc, indentspclen);
-            obuf = bxs_concat(4, restored_indent,
-                            skip_left ? empty_string : thebox[BLEF].mbcs[j]->memory,
-                            thebox[BBOT].mbcs[j - (nol - thebox[BBOT].height)]->memory,
-                            thebox[BRIG].mbcs[j]->memory);
-        }
 
-        bxstr_t *obuf_trimmed = bxs_rtrim(obuf);
-        fprintf(opt.outfile, "%s%s", bxs_to_output(obuf_trimmed),
-                    (input.final_newline || j < nol - skip_end - 1 ? opt.eol : ""));
+int measure_box(box_geometry_t *result)
+{
+    sentry_t *shape = opt.design->shape;
+    size_t tiltf[SHAPES_PER_SIDE - 2], biltf[SHAPES_PER_SIDE - 2];
+    size_t liltf[SHAPES_PER_SIDE - 2], riltf[SHAPES_PER_SIDE - 2];
+    size_t hspace = 0;
+    size_t vspace = 0;
 
-        bxs_free(obuf);
-        bxs_free(obuf_trimmed);
-        if (opt.tabexp == 'k') {
-            BFREE(restored_indent);
-        }
+    if (horiz_precalc(shape, tiltf, biltf, &hspace) || vert_precalc(shape, liltf, riltf, &vspace)) {
+        return 1;
     }
 
-    BFREE (indentspc);
-    BFREE (empty_string);
-    BFREE (hfill1);
-    BFREE (hfill2);
-    return 0;                            /* all clear */
-}
+    /* the same sizes which horiz_generate() and vert_generate() give to the sides */
+    size_t top_height = highest(shape, SHAPES_PER_SIDE, NW, NNW, N, NNE, NE);
+    size_t bottom_height = highest(shape, SHAPES_PER_SIDE, SW, SSW, S, SSE, SE);
+    size_t left_width = widest(shape, SHAPES_PER_SIDE, SW, WSW, W, WNW, NW);
+    size_t right_width = widest(shape, SHAPES_PER_SIDE, SE, ESE, E, ENE, NE);
+    size_t nol = vspace + shape[NE].height + shape[SE].height;
+
+    text_fill_t fill;
+    text_fill(hspace, nol - top_height - bottom_height, &fill);
+
+    /* sides defined empty are skipped like in output_box(); trailing blanks are counted, though not printed */
+    size_t skip_start = empty_side(shape, BTOP) ? shape[NW].height : 0;
+    size_t skip_end = empty_side(shape, BBOT) ? shape[SW].height : 0;
+    if (empty_side(shape, BLEF)) {
+        left_width = 0;
+    }
 
+    result->width = left_width + hspace + right_width;
+    result->height = nol - skip_start - skip_end;
+    result->inset[BTOP] = top_height + fill.vfill1 - skip_start;
+    result->inset[BRIG] = fill.hpr + right_width;
+    result->inset[BBOT] = fill.vfill2 + bottom_height - skip_end;
+    result->inset[BLEF] = left_width + fill.hpl;
+
+    log_debug(__FILE__, MAIN, "Box geometry: width %d, height %d, insets top %d, right %d, bottom %d, left %d\n",
+            (int) result->width, (int) result->height, (int) result->inset[BTOP], (int) result->inset[BRIG],
+            (int) result->inset[BBOT], (int) result->inset[BLEF]);
+    return 0;
+}
 
 
 /* vim: set cindent sw=4: */
@@ -20,10 +20,71 @@
 #ifndef GENERATE_H
 #define GENERATE_H
 
+#include "boxes.h"
+#include "shape.h"
 
-int generate_box(sentry_t *thebox);
 
-int output_box(const sentry_t *thebox);
+/**
+ * A vertical (left or right) side of a box, including the corners. The lines of the side are not stored one by one,
+ * which would take memory in proportion to the height of the box. Instead, the side is described by its shapes and
+ * the number of lines filled by each of them, so that any line can be looked up when it is needed.
+ */
+typedef struct {
+    size_t          width;           /** width of the side in columns */
+    size_t          height;          /** height of the side in lines, which is also the height of the box */
+    const sentry_t *top;             /** the corner shape at the top of the side */
+    const sentry_t *fill[SHAPES_PER_SIDE - 2];   /** the middle shapes of the side, from top to bottom */
+    size_t          fill_lines[SHAPES_PER_SIDE - 2];  /** number of lines filled by each of the middle shapes */
+    const sentry_t *bottom;          /** the corner shape at the bottom of the side */
+} vert_side_t;
+
+
+/**
+ * The generated sides of a box.
+ */
+typedef struct {
+    sentry_t    top;                 /** top side, excluding the corners */
+    sentry_t    bottom;              /** bottom side, excluding the corners */
+    vert_side_t left;                /** left side, including the corners */
+    vert_side_t right;               /** right side, including the corners */
+} box_t;
+
+
+int generate_box(box_t *thebox);
+
+/**
+ * Generate the sides of a box like `generate_box()`, but take over some of them from a box generated before. This is
+ * possible when the box is drawn at several sizes, and the design had the same minimum width (for the top and bottom
+ * sides) or minimum height (for the left and right sides) for both boxes. The sides taken over are shared, not copied.
+ * @param thebox (OUT) the sides of the box
+ * @param horiz_from a box whose top and bottom sides to take over, or NULL to generate them
+ * @param vert_from a box whose left and right sides to take over, or NULL to generate them
+ * @return == 0 if successful (`thebox` is set); != 0 on error
+ */
+int generate_box_reusing(box_t *thebox, const box_t *horiz_from, const box_t *vert_from);
+
+int output_box(const box_t *thebox);
+
+
+/**
+ * The size of a box and the position of the text in it, as the box would be drawn.
+ */
+typedef struct {
+    size_t width;                    /** width of the box in columns, not counting the indentation */
+    size_t height;                   /** height of the box in lines */
+    size_t inset[NUM_SIDES];         /** distance between the text block and the outer edge of the box, for each side
+                                         (`BTOP`, `BRIG`, `BBOT`, `BLEF`), including the box side and the padding */
+} box_geometry_t;
+
+
+/**
+ * Calculate the size of the box which would be drawn around the current input using the current design, without
+ * generating any part of it. The size of the design must already be adjusted to the command line options, just like
+ * for `generate_box()`. This is cheap, so it can be done for many designs in a row.
+ * @param result (OUT) the geometry of the box
+ * @return == 0 if successful (`result` is set); != 0 on error
+ */
+int measure_box(box_geometry_t *result);
 
 
 #endif /*GENERATE_H*/
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistr.h>
 #include <unitypes.h>
@@ -116,15 +117,17 @@ int apply_substitutions(input_t *result, const int mode)
     }
 
     /*
-     *  Compile regular expressions
+     *  Compile regular expressions, unless this was already done by an earlier call
      */
     log_debug(__FILE__, REGEXP, "Compiling %d %s rule patterns\n", (int) num_rules, mode ? "reversion" : "replacement");
     errno = 0;
     opt.design->current_rule = rules;
     for (j = 0; j < num_rules; ++j, ++(opt.design->current_rule)) {
-        rules[j].prog = u32_compile_pattern(rules[j].search->memory);
         if (rules[j].prog == NULL) {
-            return 5;
+            rules[j].prog = u32_compile_pattern(rules[j].search->memory);
+            if (rules[j].prog == NULL) {
+                return 5;
+            }
         }
     }
     opt.design->current_rule = NULL;
@@ -157,10 +160,15 @@ int apply_substitutions(input_t *result, const int mode)
                 return 1;
             }
 
-            bxs_free(result->lines[k].text);
-            result->lines[k].text = bxs_from_unicode(newtext);
-
-            analyze_line_ascii(result, result->lines + k);   /* update maxline value */
+            if (u32_strcmp(newtext, result->lines[k].text->memory) == 0) {
+                BFREE(newtext);                          /* nothing replaced, keep the analyzed line */
+            }
+            else {
+                bxs_free(result->lines[k].text);
+                result->lines[k].text = bxs_from_unicode(newtext);
+                BFREE(newtext);
+                analyze_line_ascii(result, result->lines + k);   /* update maxline value */
+            }
 
             if (is_debug_logging(REGEXP)) {
                 char *outtext2 = bxs_to_output(result->lines[k].text);
@@ -220,8 +228,9 @@ input_t *read_all_input()
 
     input_t *result = (input_t *) calloc(1, sizeof(input_t));
     result->indent = LINE_MAX_BYTES;
+    size_t max_lines = opt.region_first > 0 ? opt.region_last - opt.region_first + 1 : SIZE_MAX;
 
-    while (fgets(buf, LINE_MAX_BYTES + 2, opt.infile)) {
+    while (result->num_lines < max_lines && fgets(buf, LINE_MAX_BYTES + 2, opt.infile)) {
         if (result->num_lines % 100 == 0) {
             input_size += 100;
             line_t *tmp = (line_t *) realloc(result->lines, input_size * sizeof(line_t));
@@ -273,6 +282,52 @@ input_t *read_all_input()
 
 
 
+/**
+ * Determine which lines contain invisible characters, and collect the visible characters of those lines in one
+ * contiguous buffer, so that comparisons which ignore invisible characters need not filter each line separately.
+ * Mono lines need no entry in the buffer, because their visible characters are simply their text.
+ * @param input_data the input data to analyze; `mono` and `visible` are set on the input and its lines
+ * @returns == 0 on success; anything else on error
+ */
+static int collect_visible_text(input_t *input_data)
+{
+    size_t buf_len = 0;
+    input_data->mono = 1;
+    BFREE(input_data->visible);
+
+    for (size_t i = 0; i < input_data->num_lines; ++i) {
+        line_t *line = input_data->lines + i;
+        line->mono = line->text->num_chars_invisible == 0;
+        if (!line->mono) {
+            line->visible_idx = buf_len;
+            buf_len += line->text->num_chars_visible + 1;
+            input_data->mono = 0;
+        }
+    }
+    if (input_data->mono) {
+        return 0;
+    }
+
+    input_data->visible = (uint32_t *) malloc(buf_len * sizeof(uint32_t));
+    if (input_data->visible == NULL) {
+        perror(PROJECT);
+        return 1;
+    }
+    for (size_t i = 0; i < input_data->num_lines; ++i) {
+        line_t *line = input_data->lines + i;
+        if (!line->mono) {
+            uint32_t *p = input_data->visible + line->visible_idx;
+            for (size_t j = 0; j < line->text->num_chars_visible; ++j) {
+                p[j] = line->text->memory[line->text->visible_char[j]];
+            }
+            set_char_at(p, line->text->num_chars_visible, char_nul);
+        }
+    }
+    return 0;
+}
+
+
+
 int analyze_input(input_t *result)
 {
     result->indent = LINE_MAX_BYTES;
@@ -309,14 +364,18 @@ int analyze_input(input_t *result)
      */
     if (opt.design->indentmode != 't' && opt.r == 0) {
         for (size_t i = 0; i < result->num_lines; ++i) {
-            if (result->lines[i].text->num_columns >= result->indent) {
+            bxstr_t *text = result->lines[i].text;
+            if (result->indent > 0 && text->num_columns >= result->indent) {
                 /*
                  * We should really remove *columns* rather than *characters*, but since the removed characters are
                  * spaces (indentation), and there are no double-wide spaces in Unicode, both actions are equivalent.
+                 * The line is shortened in place, like bxs_cut_front() would do it, but without copying.
                  */
-                bxstr_t *unindented = bxs_cut_front(result->lines[i].text, result->indent);
-                bxs_free(result->lines[i].text);
-                result->lines[i].text = unindented;
+                size_t start_idx = result->indent < text->num_chars_visible
+                        ? text->first_char[result->indent] : text->num_chars;
+                if (bxs_substr_inplace(text, start_idx, text->num_chars, 0) != 0) {
+                    return 1;
+                }
             }
             if (is_debug_logging(MAIN)) {
                 char *outtext = bxs_to_output(result->lines[i].text);
@@ -340,7 +399,53 @@ int analyze_input(input_t *result)
         }
     }
 
-    return 0;
+    return collect_visible_text(result);
+}
+
+
+
+int analyze_mended_input(input_t *result)
+{
+    result->maxline = 0;
+    if (result->num_lines == 0) {
+        return 0;
+    }
+
+    /*
+     *  Compute indentation as if trailing whitespace had already been removed
+     */
+    size_t indent = LINE_MAX_BYTES;
+    int nonblank = 0;
+    for (size_t i = 0; i < result->num_lines; ++i) {
+        bxstr_t *text = result->lines[i].text;
+        if (text->num_columns - text->trailing > 0) {
+            nonblank = 1;
+            indent = BMIN(indent, text->indent);
+        }
+    }
+    result->indent = nonblank ? indent : 0;
+
+    /*
+     *  Remove trailing whitespace and indentation in one step. Lines which have neither are kept as they are.
+     */
+    size_t cut = opt.design->indentmode != 't' ? result->indent : 0;
+    for (size_t i = 0; i < result->num_lines; ++i) {
+        bxstr_t *text = result->lines[i].text;
+        size_t num_chars_kept = text->num_chars_visible - text->trailing;
+        size_t line_cut = text->num_columns - text->trailing >= cut ? cut : 0;
+        if (text->trailing > 0 || line_cut > 0) {
+            size_t end_idx = text->first_char[num_chars_kept];
+            size_t start_idx = line_cut < num_chars_kept ? text->first_char[line_cut] : end_idx;
+            result->lines[i].text = bxs_substr(text, start_idx, end_idx);
+            bxs_free(text);
+        }
+        analyze_line_ascii(result, result->lines + i);
+    }
+
+    if (apply_substitutions(result, 0) != 0) {
+        return 1;
+    }
+    return collect_visible_text(result);
 }
 
 
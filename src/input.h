@@ -24,7 +24,8 @@
 
 
 /**
- * Read the entire input from `opt.infile` until EOF is encountered. Tabs are expanded.
+ * Read the entire input from `opt.infile` until EOF is encountered. Tabs are expanded. When a region of lines was
+ * specified via `--region`, reading stops after the last line of the region.
  * @return a pointer to the read input data, for which new memory was allocated, or `NULL` on error
  */
 input_t *read_all_input();
@@ -32,13 +33,24 @@ input_t *read_all_input();
 
 /**
  * Analyze and prepare the input text for further processing. Compute statistics, remove indentation, and apply
- * regular expressions if specified in the design.
+ * regular expressions if specified in the design. Finally, determine which lines are mono, and collect the visible
+ * characters of the others in `input_data->visible`.
  * @param input_data the input data to analyze and modify
  * @returns == 0 on success; anything else on error
  */
 int analyze_input(input_t *input_data);
 
 
+/**
+ * Prepare the text left over from the removal of a box for having a box drawn around it again (mending). This has the
+ * same effect as trimming trailing whitespace from all lines and then calling `analyze_input()` for drawing a box, but
+ * does the trimming and the removal of indentation in one pass, and leaves lines alone which need neither.
+ * @param input_data the input data to analyze and modify
+ * @returns == 0 on success; anything else on error
+ */
+int analyze_mended_input(input_t *input_data);
+
+
 /**
  * Apply regular expression substitutions to input text. Attn: This modifies the global input array!
  * @param input_data pointer to the input data where substitutions should be applied
@@ -305,7 +305,7 @@ static int full_parse_required()
 {
     int result = 0;
     if (!opt.design_choice_by_user) {
-        result = opt.r || opt.l || (opt.query != NULL && !opt.qundoc);
+        result = opt.r || opt.l || opt.measure || (opt.query != NULL && !opt.qundoc);
     }
     log_debug(__FILE__, MAIN, " Parser: full_parse_required() -> %s\n", result ? "true" : "false");
     return result;
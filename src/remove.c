@@ -23,11 +23,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef __MINGW32__
+    #include <pthread.h>
+#endif
 #include <unistr.h>
 #include <uniwidth.h>
 
 #include "boxes.h"
 #include "detect.h"
+#include "input.h"
 #include "logging.h"
 #include "remove.h"
 #include "shape.h"
@@ -36,6 +40,14 @@
 
 
 
+/** the minimum number of body lines each worker thread gets when matching the vertical sides in parallel */
+#define MIN_BODY_LINES_PER_THREAD 2048
+
+/** the maximum number of worker threads used for matching the vertical sides */
+#define MAX_BODY_THREADS 8
+
+
+
 typedef struct _line_ctx_t {
     /** index of the first character of the west shape */
     size_t west_start;
@@ -63,6 +75,17 @@ typedef struct _line_ctx_t {
 
 
 
+/** The characters which occur in the shapes of a horizontal box side */
+typedef struct _side_chars_t {
+    /** bitmap of the ASCII characters */
+    uint32_t ascii[4];
+
+    /** the other characters as a NUL-terminated string, NULL if there are none */
+    uint32_t *other;
+} side_chars_t;
+
+
+
 typedef struct _remove_ctx_t {
     /** Array of flags indicating which sides of the box design are defined as empty. Access via `BTOP` etc. constants. */
     int empty_side[NUM_SIDES];
@@ -90,6 +113,17 @@ typedef struct _remove_ctx_t {
     /** The current comparison type. This changes whenever another comparison type is tried. */
     comparison_t comp_type;
 
+    /** Indentation of the box, which is restored on the body lines unless the indentation mode says otherwise. */
+    size_t indent;
+
+    /** Match quality of the vertical sides in percent of the best possible match, as found by the last call to
+     *  `sufficient_body_quality()` */
+    int quality;
+
+    /** The characters of the top and bottom sides. Only used when looking for multiple boxes, where they allow lines
+     *  to be rejected quickly. Access via `BTOP` and `BBOT`. */
+    side_chars_t side_chars[NUM_SIDES];
+
     /** number of lines in `body` */
     size_t body_num_lines;
 
@@ -233,13 +267,16 @@ static int is_blank_between(uint32_t *start, uint32_t *end)
 
 
 /**
- * Take a shape line and shorten it by cutting off blanks from both ends.
+ * Take a shape line and shorten it by cutting off blanks from both ends. No memory is allocated; the result is a view
+ * into the original shape line.
  * @param shape_line_ctx info record on the shape line to work on. Contains the original shape line, unshortened.
  * @param quality (IN/OUT) the current quality, here the value that was last tested. We will reduce this by one.
+ *      On return, this is the length of the shortened shape line.
  * @param prefer_left if 1, first cut all blanks from the start of the shape line, if 0, first cut at the end
  * @param allow_left if 1, blanks may be cut from the left of the shape line, if 0, we never cut from the left
  * @param allow_right if 1, blanks may be cut from the right of the shape line, if 0, we never cut from the right
- * @return the shortened shape line, in new memory, or NULL if further shortening was not possible
+ * @return pointer to the start of the shortened shape line in the memory of the original shape line, which is
+ *      `*quality` characters long and not terminated; or NULL if further shortening was not possible
  */
 uint32_t *shorten(shape_line_ctx_t *shape_line_ctx, size_t *quality, int prefer_left, int allow_left, int allow_right)
 {
@@ -280,8 +317,7 @@ uint32_t *shorten(shape_line_ctx_t *shape_line_ctx, size_t *quality, int prefer_
     uint32_t *result = NULL;
     size_t new_quality = e - s;
     if (new_quality < *quality) {
-        result = u32_strdup(s);
-        set_char_at(result, new_quality, char_nul);
+        result = s;
         *quality = new_quality;
     }
     return result;
@@ -289,106 +325,141 @@ uint32_t *shorten(shape_line_ctx_t *shape_line_ctx, size_t *quality, int prefer_
 
 
 
-static int hmm_shiftable(shape_line_ctx_t *shapes_relevant, uint32_t *cur_pos, size_t shape_idx, uint32_t *end_pos,
-        int anchored_right);
+/** memo table entry value for a state of the horizontal matcher which was not yet computed */
+#define HMM_UNKNOWN -1
 
 
 
 /**
- * (horizontal middle match)
- * Recursive helper function for match_horiz_line(), uses backtracking.
- * @param shapes_relevant the prepared shape lines to be concatenated
- * @param cur_pos current position in the input line being matched
- * @param shape_idx index into `shapes_relevant` indicating which shape to try now
- * @param end_pos first character of the east corner
- * @param anchored_left flag indicating that `cur_pos` is already "anchored" or still "shiftable". "Anchored" means
- *      that we have matched a non-blank shape line already (corner shape line was not blank). Else "shiftable".
- * @param anchored_right flag indicating that the east corner shape was not blank. If this is `false`, it means that
- *      a shape may be shortened right if only blank shape lines follow.
- * @return `== 1`: success;
- *         `== 0`: failed to match
+ * Invariant state of one horizontal middle match. The result of matching a given shape index from a given input
+ * position depends only on these values, so it is computed only once and remembered in `memo`.
  */
-int hmm(shape_line_ctx_t *shapes_relevant, uint32_t *cur_pos, size_t shape_idx, uint32_t *end_pos, int anchored_left,
-        int anchored_right)
+typedef struct _hmm_ctx_t {
+    /** the prepared shape lines to be concatenated */
+    shape_line_ctx_t *shapes_relevant;
+
+    /** the position in the input line where matching started; the memo table is relative to this */
+    uint32_t *start_pos;
+
+    /** first character of the east corner */
+    uint32_t *end_pos;
+
+    /** flag indicating that the east corner shape was not blank */
+    int anchored_right;
+
+    /** match results per (input position - `start_pos`, shape index), `HMM_UNKNOWN` if not yet computed */
+    signed char *memo;
+} hmm_ctx_t;
+
+
+
+static int hmm_anchored(hmm_ctx_t *hctx, uint32_t *cur_pos, size_t shape_idx);
+
+
+
+static int hmm_match_shape(hmm_ctx_t *hctx, uint32_t *cur_pos, size_t shape_idx)
 {
-    if (is_debug_logging(MAIN)) {
-        char *out_cur_pos = u32_strconv_to_output(cur_pos);
-        char *out_end_pos = u32_strconv_to_output(end_pos);
-        log_debug(__FILE__, MAIN, "hmm(shapes_relevant, \"%s\", %d, \"%s\", %s, %s) - enter\n", out_cur_pos,
-                (int) shape_idx, out_end_pos, anchored_left ? "true" : "false", anchored_right ? "true" : "false");
-        BFREE(out_cur_pos);
-        BFREE(out_end_pos);
-    }
+    shape_line_ctx_t *shapes_relevant = hctx->shapes_relevant;
+    uint32_t *end_pos = hctx->end_pos;
 
-    int result = 0;
-    if (!anchored_left) {
-        result = hmm_shiftable(shapes_relevant, cur_pos, shape_idx, end_pos, anchored_right);
-    }
-    else if (cur_pos > end_pos) {
-        /* invalid input */
-        result = 0;
-    }
-    else if (cur_pos == end_pos) {
+    if (cur_pos == end_pos) {
         /* we are at the end, which is fine if there is nothing else to match */
-        result = (shape_idx == (SHAPES_PER_SIDE - 1) && anchored_right)
+        return (shape_idx == (SHAPES_PER_SIDE - 1) && hctx->anchored_right)
                 || ((shapes_relevant[shape_idx].empty || bxs_is_blank(shapes_relevant[shape_idx].text))
                     && !non_empty_shapes_after(shapes_relevant, shape_idx) ? 1 : 0);
     }
-    else if (shape_idx >= SHAPES_PER_SIDE - 1) {
+    if (shape_idx >= SHAPES_PER_SIDE - 1) {
         /* no more shapes to try, which is fine if the rest of the line is blank */
-        result = u32_is_blank(cur_pos);
+        return u32_is_blank(cur_pos);
     }
-    else if (shapes_relevant[shape_idx].empty) {
+    if (shapes_relevant[shape_idx].empty) {
         /* the current shape line is empty, try the next one */
-        result = hmm(shapes_relevant, cur_pos, shape_idx + 1, end_pos, 1, anchored_right);
+        return hmm_anchored(hctx, cur_pos, shape_idx + 1);
     }
-    else {
-        uint32_t *shape_line = u32_strdup(shapes_relevant[shape_idx].text->memory);
-        size_t quality = shapes_relevant[shape_idx].text->num_chars;
-        while (shape_line != NULL && quality > 0) {
-            if (u32_strncmp(cur_pos, shape_line, quality) == 0) {
-                BFREE(shape_line);
-                cur_pos = cur_pos + quality;
-                if (cur_pos == end_pos && !non_empty_shapes_after(shapes_relevant, shape_idx)) {
-                    result = 1; /* success */
+
+    int result = 0;
+    uint32_t *shape_line = shapes_relevant[shape_idx].text->memory;
+    size_t quality = shapes_relevant[shape_idx].text->num_chars;
+    while (shape_line != NULL && quality > 0) {
+        spend_work(1);
+        if (u32_strncmp(cur_pos, shape_line, quality) == 0) {
+            shape_line = NULL;
+            cur_pos = cur_pos + quality;
+            if (cur_pos == end_pos && !non_empty_shapes_after(shapes_relevant, shape_idx)) {
+                result = 1; /* success */
+            }
+            else {
+                int rc = 0;
+                if (shapes_relevant[shape_idx].elastic) {
+                    rc = hmm_anchored(hctx, cur_pos, shape_idx);
                 }
-                else {
-                    int rc = 0;
-                    if (shapes_relevant[shape_idx].elastic) {
-                        rc = hmm(shapes_relevant, cur_pos, shape_idx, end_pos, 1, anchored_right);
-                    }
-                    if (rc == 0) {
-                        result = hmm(shapes_relevant, cur_pos, shape_idx + 1, end_pos, 1, anchored_right);
-                    }
-                    else {
-                        result = rc;
-                    }
+                if (rc == 0) {
+                    result = hmm_anchored(hctx, cur_pos, shape_idx + 1);
                 }
-            }
-            else if (!anchored_right) {
-                shape_line = shorten(shapes_relevant + shape_idx, &quality, 0, 0, 1);
-                if (is_debug_logging(MAIN)) {
-                    char *out_shape_line = u32_strconv_to_output(shape_line);
-                    log_debug(__FILE__, MAIN, "hmm() - shape_line shortened to %d (\"%s\")\n",
-                            (int) quality, out_shape_line);
-                    BFREE(out_shape_line);
+                else {
+                    result = rc;
                 }
             }
-            else {
-                BFREE(shape_line);
+        }
+        else if (!hctx->anchored_right) {
+            shape_line = shorten(shapes_relevant + shape_idx, &quality, 0, 0, 1);
+            if (is_debug_logging(MAIN) && shape_line != NULL) {
+                uint32_t *shortened = u32_strdup(shape_line);
+                set_char_at(shortened, quality, char_nul);
+                char *out_shape_line = u32_strconv_to_output(shortened);
+                log_debug(__FILE__, MAIN, "hmm() - shape_line shortened to %d (\"%s\")\n",
+                        (int) quality, out_shape_line);
+                BFREE(out_shape_line);
+                BFREE(shortened);
             }
         }
+        else {
+            shape_line = NULL;
+        }
     }
+    return result;
+}
 
-    log_debug(__FILE__, MAIN, "hmm() - exit, result = %d\n", result);
+
+
+/**
+ * Match the shapes starting at `shape_idx` against the input starting at `cur_pos`, which is anchored. Every
+ * (position, shape index) pair is evaluated at most once, so elastic shapes which can be repeated in many different
+ * ways do not lead to an explosion of the search.
+ * @param hctx the invariant state of this match
+ * @param cur_pos current position in the input line being matched
+ * @param shape_idx index into `hctx->shapes_relevant` indicating which shape to try now
+ * @return `== 1`: success;
+ *         `== 0`: failed to match
+ */
+static int hmm_anchored(hmm_ctx_t *hctx, uint32_t *cur_pos, size_t shape_idx)
+{
+    if (cur_pos > hctx->end_pos || work_limit_exceeded(0)) {
+        /* invalid input, or no more time to find out */
+        return 0;
+    }
+
+    signed char *memo = NULL;
+    if (hctx->memo != NULL && cur_pos >= hctx->start_pos && shape_idx < SHAPES_PER_SIDE) {
+        memo = hctx->memo + (cur_pos - hctx->start_pos) * SHAPES_PER_SIDE + shape_idx;
+        if (*memo != HMM_UNKNOWN) {
+            return *memo;
+        }
+    }
+
+    int result = hmm_match_shape(hctx, cur_pos, shape_idx);
+    if (memo != NULL) {
+        *memo = (signed char) result;
+    }
     return result;
 }
 
 
 
-static int hmm_shiftable(shape_line_ctx_t *shapes_relevant, uint32_t *cur_pos, size_t shape_idx, uint32_t *end_pos,
-        int anchored_right)
+static int hmm_shiftable(hmm_ctx_t *hctx, uint32_t *cur_pos, size_t shape_idx)
 {
+    shape_line_ctx_t *shapes_relevant = hctx->shapes_relevant;
+    uint32_t *end_pos = hctx->end_pos;
     int result = 0;
     int shapes_are_empty = 1;
     for (size_t i = shape_idx; i < SHAPES_PER_SIDE - 1; i++) {
@@ -397,13 +468,13 @@ static int hmm_shiftable(shape_line_ctx_t *shapes_relevant, uint32_t *cur_pos, s
             int can_shorten_right = -1;
             size_t quality = shapes_relevant[i].text->num_chars;
             uint32_t *shape_line = shapes_relevant[i].text->memory;
-            while (shape_line != NULL) {
-                uint32_t *p = u32_strstr(cur_pos, shape_line);
+            while (shape_line != NULL && !work_limit_exceeded(0)) {
+                spend_work(1);
+                uint32_t *p = u32_find_first(cur_pos, u32_strlen(cur_pos), shape_line, quality);
                 if (p != NULL && p < end_pos && is_blank_between(cur_pos, p)) {
-                    result = hmm(shapes_relevant, p + quality, i + (shapes_relevant[i].elastic ? 0 : 1),
-                            end_pos, 1, anchored_right);
+                    result = hmm_anchored(hctx, p + quality, i + (shapes_relevant[i].elastic ? 0 : 1));
                     if (result == 0 && shapes_relevant[i].elastic) {
-                        result = hmm(shapes_relevant, p + quality, i + 1, end_pos, 1, anchored_right);
+                        result = hmm_anchored(hctx, p + quality, i + 1);
                     }
                     break;
                 }
@@ -426,6 +497,89 @@ static int hmm_shiftable(shape_line_ctx_t *shapes_relevant, uint32_t *cur_pos, s
 
 
 
+/**
+ * (horizontal middle match)
+ * Helper function for match_horiz_line(). Tries all ways of fitting the (elastic) shapes between `cur_pos` and
+ * `end_pos`, remembering the outcome for each input position and shape index, so the effort grows only linearly with
+ * the width of the line.
+ * @param shapes_relevant the prepared shape lines to be concatenated
+ * @param cur_pos current position in the input line being matched
+ * @param shape_idx index into `shapes_relevant` indicating which shape to try now
+ * @param end_pos first character of the east corner
+ * @param anchored_left flag indicating that `cur_pos` is already "anchored" or still "shiftable". "Anchored" means
+ *      that we have matched a non-blank shape line already (corner shape line was not blank). Else "shiftable".
+ * @param anchored_right flag indicating that the east corner shape was not blank. If this is `false`, it means that
+ *      a shape may be shortened right if only blank shape lines follow.
+ * @return `== 1`: success;
+ *         `== 0`: failed to match
+ */
+int hmm(shape_line_ctx_t *shapes_relevant, uint32_t *cur_pos, size_t shape_idx, uint32_t *end_pos, int anchored_left,
+        int anchored_right)
+{
+    if (is_debug_logging(MAIN)) {
+        char *out_cur_pos = u32_strconv_to_output(cur_pos);
+        char *out_end_pos = u32_strconv_to_output(end_pos);
+        log_debug(__FILE__, MAIN, "hmm(shapes_relevant, \"%s\", %d, \"%s\", %s, %s) - enter\n", out_cur_pos,
+                (int) shape_idx, out_end_pos, anchored_left ? "true" : "false", anchored_right ? "true" : "false");
+        BFREE(out_cur_pos);
+        BFREE(out_end_pos);
+    }
+
+    hmm_ctx_t hctx;
+    hctx.shapes_relevant = shapes_relevant;
+    hctx.start_pos = cur_pos;
+    hctx.end_pos = end_pos;
+    hctx.anchored_right = anchored_right;
+    hctx.memo = NULL;
+
+    int result = 0;
+    if (cur_pos <= end_pos) {
+        size_t num_entries = ((size_t) (end_pos - cur_pos) + 1) * SHAPES_PER_SIDE;
+        hctx.memo = (signed char *) malloc(num_entries);
+        if (hctx.memo == NULL) {
+            perror(PROJECT);
+            return 0;
+        }
+        memset(hctx.memo, HMM_UNKNOWN, num_entries);
+
+        result = anchored_left ? hmm_anchored(&hctx, cur_pos, shape_idx) : hmm_shiftable(&hctx, cur_pos, shape_idx);
+        BFREE(hctx.memo);
+    }
+    else if (!anchored_left) {
+        result = hmm_shiftable(&hctx, cur_pos, shape_idx);
+    }
+
+    log_debug(__FILE__, MAIN, "hmm() - exit, result = %d\n", result);
+    return result;
+}
+
+
+
+/**
+ * Determine whether the given shapes are free of invisible characters.
+ * @param shapes the shapes to check; empty shapes are ignored
+ * @param num_shapes the number of elements in `shapes`
+ * @param shape_line_idx the index of the shape line to check, or -1 to check all lines of the shapes
+ * @return flag indicating that none of the checked shape lines contains invisible characters
+ */
+static int shapes_are_mono(shape_t *shapes, size_t num_shapes, long shape_line_idx)
+{
+    for (size_t i = 0; i < num_shapes; i++) {
+        sentry_t *shape = opt.design->shape + shapes[i];
+        if (isempty(shape)) {
+            continue;
+        }
+        for (size_t slno = 0; slno < shape->height; slno++) {
+            if ((shape_line_idx < 0 || (size_t) shape_line_idx == slno) && shape->mbcs[slno]->num_chars_invisible > 0) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
+
 static shape_line_ctx_t *prepare_comp_shapes_horiz(int hside, comparison_t comp_type, size_t shape_line_idx)
 {
     shape_t *side_shapes = hside == BTOP ? north_side : south_side_rev;
@@ -479,7 +633,8 @@ match_result_t *match_outer_shape(int vside, bxstr_t *input_line, bxstr_t *shape
             return new_match_result(input_line->memory, 0, 0, 1);
         }
         for (uint32_t *s = shape_line->memory; s == shape_line->memory || is_blank(*s); s++) {
-            uint32_t *p = u32_strstr(input_line->memory, s);
+            uint32_t *p = u32_find_first(input_line->memory, input_line->num_chars,
+                    s, shape_line->num_chars - (s - shape_line->memory));
             size_t p_idx = p != NULL ? p - input_line->memory : 0;
             if (p == NULL || p_idx > input_line->first_char[input_line->indent]) {
                 continue;  /* not found or found too far in */
@@ -494,19 +649,16 @@ match_result_t *match_outer_shape(int vside, bxstr_t *input_line, bxstr_t *shape
             return new_match_result(p, p_idx, 0, 1);
         }
         int slen = shape_line->num_chars;
-        uint32_t *s = u32_strdup(shape_line->memory);
+        uint32_t *s = shape_line->memory;
         for (; slen == (int) shape_line->num_chars || is_blank(s[slen]); slen--) {
-            s[slen] = char_nul;
-            uint32_t *p = u32_strnrstr(input_line->memory, s, slen);
+            uint32_t *p = u32_find_last(input_line->memory, input_line->num_chars, s, slen);
             size_t p_idx = p != NULL ? p - input_line->memory : 0;
             if (p == NULL || p_idx + slen
                     < input_line->first_char[input_line->num_chars_visible - input_line->trailing]) {
                 continue; /* not found or found too far in */
             }
-            BFREE(s);
             return new_match_result(p, p_idx, (size_t) slen, 0);
         }
-        BFREE(s);
     }
     return NULL;
 }
@@ -518,12 +670,25 @@ static int match_horiz_line(remove_ctx_t *ctx, int hside, size_t input_line_idx,
     log_debug(__FILE__, MAIN, "match_horiz_line(ctx, %s, %d, %d)\n",
                 hside == BTOP ? "BTOP" : "BBOT", (int) input_line_idx, (int) shape_line_idx);
 
+    /* comparison types which would compare this line in the same way as one which failed need not be tried */
+    int mono_line = input.lines[input_line_idx].mono;
+    int mono_shapes = shapes_are_mono(hside == BTOP ? north_side : south_side_rev, SHAPES_PER_SIDE,
+            (long) shape_line_idx);
+    int tried[NUM_COMPARISON_TYPES] = {0};
+
     int result = 0;
-    for (comparison_t comp_type = 0; comp_type < NUM_COMPARISON_TYPES; comp_type++) {
+    for (comparison_t comp_type = 0; comp_type < NUM_COMPARISON_TYPES && !work_limit_exceeded(0); comp_type++) {
         if (!comp_type_is_viable(comp_type, ctx->input_is_mono, ctx->design_is_mono)) {
             continue;
         }
         ctx->comp_type = comp_type;
+        comparison_t effective = effective_comp_type(comp_type, mono_line, mono_shapes);
+        if (tried[effective]) {
+            log_debug(__FILE__, MAIN, "  Skipping comparison type %s, same as %s\n", comparison_name[comp_type],
+                    comparison_name[effective]);
+            continue;
+        }
+        tried[effective] = 1;
         log_debug(__FILE__, MAIN, "  Setting comparison type to: %s\n", comparison_name[comp_type]);
 
         shape_line_ctx_t *shapes_relevant = prepare_comp_shapes_horiz(hside, comp_type, shape_line_idx);
@@ -710,10 +875,23 @@ static void free_shape_lines(shape_line_ctx_t **shape_lines)
 
 
 
-static void match_vertical_side(remove_ctx_t *ctx, int vside, shape_line_ctx_t **shape_lines, uint32_t *input_line,
+/**
+ * Find the best match of the shape lines of a vertical side on one body line, and store it in `ctx->body`.
+ * @param ctx the removal context
+ * @param vside the vertical side to match, `BLEF` or `BRIG`
+ * @param shape_lines the prepared shape lines of the side, NULL-terminated
+ * @param input_line the prepared body line
+ * @param line_idx index into `input.lines` of the body line
+ * @param input_length the number of characters in `input_line`
+ * @param input_indent the number of characters at the start of `input_line` which are part of the indent
+ * @param input_trailing the number of characters at the end of `input_line` which are trailing
+ * @return the number of steps spent, which the caller must count against the work limit
+ */
+static size_t match_vertical_side(remove_ctx_t *ctx, int vside, shape_line_ctx_t **shape_lines, uint32_t *input_line,
     size_t line_idx, size_t input_length, size_t input_indent, size_t input_trailing)
 {
     line_ctx_t *line_ctx = ctx->body + (line_idx - ctx->top_end_idx);
+    size_t steps = 0;
 
     for (shape_line_ctx_t **shape_line_ctx = shape_lines; *shape_line_ctx != NULL; shape_line_ctx++) {
         if ((*shape_line_ctx)->empty) {
@@ -723,23 +901,21 @@ static void match_vertical_side(remove_ctx_t *ctx, int vside, shape_line_ctx_t *
         size_t max_quality = (*shape_line_ctx)->text->num_chars;
         size_t quality = max_quality;
         uint32_t *shape_text = (*shape_line_ctx)->text->memory;
-        uint32_t *to_free = NULL;
         while(shape_text != NULL) {
             uint32_t *p;
+            ++steps;
             if (vside == BLEF) {
-                p = u32_strstr(input_line, shape_text);
+                p = u32_find_first(input_line, input_length, shape_text, quality);
             }
             else {
-                p = u32_strnrstr(input_line, shape_text, quality);
+                p = u32_find_last(input_line, input_length, shape_text, quality);
             }
-            BFREE(to_free);
             shape_text = NULL;
 
             if ((p == NULL)
                     || (vside == BLEF && ((size_t) (p - input_line) > input_indent + (max_quality - quality)))
                     || (vside == BRIG && ((size_t) (p - input_line) < input_length - input_trailing - quality))) {
                 shape_text = shorten(*shape_line_ctx, &quality, vside == BLEF, 1, 1);
-                to_free = shape_text;
             }
             else if (vside == BLEF) {
                 if (quality > line_ctx->west_quality) {
@@ -763,20 +939,20 @@ static void match_vertical_side(remove_ctx_t *ctx, int vside, shape_line_ctx_t *
             }
         }
     }
+    return steps;
 }
 
 
 
-static int sufficient_body_quality(remove_ctx_t *ctx)
+/**
+ * Decide whether the vertical sides were matched well enough to stop trying other comparison types.
+ * @param ctx the removal context
+ * @param total_quality the sum of the east and west match qualities of all body lines
+ * @return flag indicating that the match quality is sufficient
+ */
+static int sufficient_body_quality(remove_ctx_t *ctx, size_t total_quality)
 {
     size_t num_body_lines = ctx->bottom_start_idx - ctx->top_end_idx;
-    size_t total_quality = 0;
-    line_ctx_t *body = ctx->body;
-    for (size_t body_line_idx = 0; body_line_idx < num_body_lines; body_line_idx++) {
-        line_ctx_t line_ctx = body[body_line_idx];
-        total_quality += line_ctx.east_quality + line_ctx.west_quality;
-    }
-
     size_t max_quality = 0;
     if (!ctx->empty_side[BLEF]) {
         max_quality += opt.design->shape[NW].width;
@@ -789,6 +965,7 @@ static int sufficient_body_quality(remove_ctx_t *ctx)
     /* If we manage to match 50%, then it is unlikely to improve with a different comparison mode. */
     int sufficient = (max_quality == 0 && total_quality == 0)
             || (max_quality > 0 && (total_quality > 0.5 * max_quality));
+    ctx->quality = max_quality > 0 ? (int) BMIN(total_quality * 100 / max_quality, (size_t) 100) : 100;
     log_debug(__FILE__, MAIN, "sufficient_body_quality() found body match quality of %d/%d (%s).\n",
             (int) total_quality, (int) max_quality, sufficient ? "sufficient" : "NOT sufficient");
 
@@ -797,33 +974,217 @@ static int sufficient_body_quality(remove_ctx_t *ctx)
 
 
 
-static void reset_body(remove_ctx_t *ctx)
+static void free_body_lines(line_ctx_t *body, size_t num_lines)
 {
-    if (ctx->body != NULL) {
-        for (size_t i = 0; i < ctx->body_num_lines; i++) {
-            BFREE(ctx->body[i].input_line_used);
+    if (body != NULL) {
+        for (size_t i = 0; i < num_lines; i++) {
+            BFREE(body[i].input_line_used);
+        }
+        BFREE(body);
+    }
+}
+
+
+
+/** a range of body lines to be matched against the vertical sides, possibly by a worker thread */
+typedef struct _body_range_t {
+    /** the removal context, whose `body` receives the match results */
+    remove_ctx_t *ctx;
+
+    /** the comparison type to use */
+    comparison_t comp_type;
+
+    /** the body line results of the comparison types tried before `comp_type`, indexed by comparison type; NULL for
+     *  the types which were not tried */
+    line_ctx_t **earlier_body;
+
+    /** flag indicating that the shapes of both vertical sides are free of invisible characters */
+    int mono_shapes;
+
+    /** the prepared west side shape lines, NULL if the west side is empty */
+    shape_line_ctx_t **shape_lines_west;
+
+    /** the prepared east side shape lines, NULL if the east side is empty */
+    shape_line_ctx_t **shape_lines_east;
+
+    /** index of the first input line of the range */
+    size_t from_idx;
+
+    /** index of the input line following the range */
+    size_t to_idx;
+
+    /** (OUT) the sum of the east and west match qualities of the lines in the range */
+    size_t total_quality;
+
+    /** (OUT) the number of steps spent on the range, not yet counted against the work limit */
+    size_t steps;
+} body_range_t;
+
+
+
+/**
+ * Find the result of an earlier comparison type which compared the given input line in exactly the same way as the
+ * current comparison type would, so that it can be reused.
+ * @param range the range of lines being processed
+ * @param input_line_idx index into `input.lines` of the line to check
+ * @return the earlier result for the line, or NULL if the line must be matched again
+ */
+static line_ctx_t *earlier_line_result(body_range_t *range, size_t input_line_idx)
+{
+    int mono_line = input.lines[input_line_idx].mono;
+    comparison_t effective = effective_comp_type(range->comp_type, mono_line, range->mono_shapes);
+    for (comparison_t comp_type = 0; comp_type < range->comp_type; comp_type++) {
+        if (range->earlier_body[comp_type] != NULL
+                && effective_comp_type(comp_type, mono_line, range->mono_shapes) == effective)
+        {
+            return range->earlier_body[comp_type] + (input_line_idx - range->ctx->top_end_idx);
         }
-        memset(ctx->body, 0, ctx->body_num_lines * sizeof(line_ctx_t));
     }
+    return NULL;
 }
 
 
 
-static void find_vertical_shapes(remove_ctx_t *ctx)
+/**
+ * Match the vertical sides against the input lines of the given range. Each line only writes its own slot in
+ * `ctx->body`, so different ranges can be processed concurrently. Lines which an earlier comparison type already
+ * compared in the same way are not matched again. Processing stops when the work limit is exceeded.
+ * @param range the range of lines to process; its `total_quality` and `steps` are set as a result
+ * @return the sum of the east and west match qualities of the lines in the range
+ */
+static size_t match_body_range(body_range_t *range)
+{
+    remove_ctx_t *ctx = range->ctx;
+    range->total_quality = 0;
+    range->steps = 0;
+    for (size_t input_line_idx = range->from_idx;
+            input_line_idx < range->to_idx && !work_limit_exceeded(range->steps); input_line_idx++)
+    {
+        line_ctx_t *line_ctx = ctx->body + (input_line_idx - ctx->top_end_idx);
+        line_ctx_t *earlier = earlier_line_result(range, input_line_idx);
+        if (earlier != NULL) {
+            *line_ctx = *earlier;
+            line_ctx->input_line_used = earlier->input_line_used != NULL ? u32_strdup(earlier->input_line_used) : NULL;
+            range->total_quality += line_ctx->west_quality + line_ctx->east_quality;
+            continue;
+        }
+
+        size_t input_indent = 0;
+        size_t input_trailing = 0;
+        uint32_t *input_line = prepare_comp_input(input_line_idx, 0, range->comp_type, 0,
+                &input_indent, &input_trailing);
+        size_t input_length = u32_strlen(input_line);
+
+        if (range->shape_lines_west != NULL) {
+            range->steps += match_vertical_side(ctx, BLEF, range->shape_lines_west,
+                    input_line, input_line_idx, input_length, input_indent, input_trailing);
+        }
+        if (range->shape_lines_east != NULL) {
+            range->steps += match_vertical_side(ctx, BRIG, range->shape_lines_east,
+                    input_line, input_line_idx, input_length, input_indent, input_trailing);
+        }
+        range->total_quality += line_ctx->west_quality + line_ctx->east_quality;
+    }
+    return range->total_quality;
+}
+
+
+
+#ifndef __MINGW32__
+
+static void *match_body_range_thread(void *arg)
+{
+    match_body_range((body_range_t *) arg);
+    return NULL;
+}
+
+#endif
+
+
+
+/**
+ * Match the vertical sides against all body lines of the given range. For large inputs, the range is split into
+ * chunks which are processed by worker threads. The results are the same as when processing serially. The steps spent
+ * are counted against the work limit once all chunks are done; whether the limit was exceeded does not depend on the
+ * number of threads, because each chunk stops only when its own steps alone exceed the limit.
+ * @param range the range of lines to process
+ * @return the sum of the east and west match qualities of all lines in the range
+ */
+static size_t match_body_lines(body_range_t *range)
+{
+    #ifndef __MINGW32__
+        size_t num_threads = num_worker_threads(range->to_idx - range->from_idx, MIN_BODY_LINES_PER_THREAD,
+                MAX_BODY_THREADS);
+        if (num_threads > 1) {
+            pthread_t threads[MAX_BODY_THREADS];
+            int started[MAX_BODY_THREADS];
+            body_range_t chunks[MAX_BODY_THREADS];
+            size_t chunk_size = (range->to_idx - range->from_idx + num_threads - 1) / num_threads;
+            for (size_t t = 0; t < num_threads; t++) {
+                chunks[t] = *range;
+                chunks[t].from_idx = BMIN(range->from_idx + t * chunk_size, range->to_idx);
+                chunks[t].to_idx = BMIN(chunks[t].from_idx + chunk_size, range->to_idx);
+                started[t] = pthread_create(threads + t, NULL, match_body_range_thread, chunks + t) == 0;
+                if (!started[t]) {
+                    match_body_range(chunks + t);
+                }
+            }
+
+            range->total_quality = 0;
+            range->steps = 0;
+            for (size_t t = 0; t < num_threads; t++) {
+                if (started[t]) {
+                    pthread_join(threads[t], NULL);
+                }
+                range->total_quality += chunks[t].total_quality;
+                range->steps += chunks[t].steps;
+            }
+            spend_work(range->steps);
+            log_debug(__FILE__, MAIN, "match_body_lines(): matched %d body lines using %d threads\n",
+                    (int) (range->to_idx - range->from_idx), (int) num_threads);
+            return range->total_quality;
+        }
+    #endif
+    size_t total_quality = match_body_range(range);
+    spend_work(range->steps);
+    return total_quality;
+}
+
+
+
+/**
+ * Match the vertical sides of the box against the body lines, trying the comparison types in turn until the match
+ * quality is sufficient. The results of each comparison type are kept, so that a body line which the next type would
+ * compare in the same way (because it contains no invisible characters, for example) is not matched again.
+ * @param ctx the removal context, whose `body` receives the match results
+ * @return flag indicating that the match quality was sufficient (always true if both vertical sides are empty); false
+ *      if the work limit was exceeded, in which case `body` is incomplete
+ */
+static int find_vertical_shapes(remove_ctx_t *ctx)
 {
     int west_empty = ctx->empty_side[BLEF];
     int east_empty = ctx->empty_side[BRIG];
     if (west_empty && east_empty) {
-        return;
+        return 1;
     }
 
+    shape_t vert_shapes[] = {WNW, W, WSW, ENE, E, ESE};
+    int mono_shapes = shapes_are_mono(vert_shapes, sizeof(vert_shapes) / sizeof(shape_t), -1);
+    line_ctx_t *earlier_body[NUM_COMPARISON_TYPES] = {NULL};
+    int tried = 0;
+
+    int sufficient = 0;
     for (comparison_t comp_type = 0; comp_type < NUM_COMPARISON_TYPES; comp_type++) {
         if (!comp_type_is_viable(comp_type, ctx->input_is_mono, ctx->design_is_mono)) {
             continue;
         }
+        if (tried) {
+            earlier_body[ctx->comp_type] = ctx->body;
+            ctx->body = (line_ctx_t *) calloc(ctx->body_num_lines, sizeof(line_ctx_t));
+        }
         ctx->comp_type = comp_type;
+        tried = 1;
         log_debug(__FILE__, MAIN, "find_vertical_shapes(): comp_type = %s\n", comparison_name[comp_type]);
-        reset_body(ctx);
 
         shape_line_ctx_t **shape_lines_west = NULL;
         if (!west_empty) {
@@ -834,29 +1195,33 @@ static void find_vertical_shapes(remove_ctx_t *ctx)
             shape_lines_east = prepare_comp_shapes_vert(BRIG, comp_type);
         }
 
-        for (size_t input_line_idx = ctx->top_end_idx; input_line_idx < ctx->bottom_start_idx; input_line_idx++) {
-            size_t input_indent = 0;
-            size_t input_trailing = 0;
-            uint32_t *input_line = prepare_comp_input(input_line_idx, 0, comp_type, 0, &input_indent, &input_trailing);
-            size_t input_length = u32_strlen(input_line);
-
-            if (!west_empty) {
-                match_vertical_side(ctx, BLEF, shape_lines_west,
-                        input_line, input_line_idx, input_length, input_indent, input_trailing);
-            }
-            if (!east_empty) {
-                match_vertical_side(ctx, BRIG, shape_lines_east,
-                        input_line, input_line_idx, input_length, input_indent, input_trailing);
-            }
-        }
+        body_range_t range;
+        range.ctx = ctx;
+        range.comp_type = comp_type;
+        range.earlier_body = earlier_body;
+        range.mono_shapes = mono_shapes;
+        range.shape_lines_west = shape_lines_west;
+        range.shape_lines_east = shape_lines_east;
+        range.from_idx = ctx->top_end_idx;
+        range.to_idx = ctx->bottom_start_idx;
+        size_t total_quality = match_body_lines(&range);
 
         free_shape_lines(shape_lines_west);
         free_shape_lines(shape_lines_east);
 
-        if (sufficient_body_quality(ctx)) {
+        if (work_limit_exceeded(0)) {
+            break;   /* the results are incomplete */
+        }
+        if (sufficient_body_quality(ctx, total_quality)) {
+            sufficient = 1;
             break;
         }
     }
+
+    for (comparison_t comp_type = 0; comp_type < NUM_COMPARISON_TYPES; comp_type++) {
+        free_body_lines(earlier_body[comp_type], ctx->body_num_lines);
+    }
+    return sufficient;
 }
 
 
@@ -887,7 +1252,6 @@ static void detect_design_if_needed()
 
 static void free_line_text(line_t *line)
 {
-    BFREE(line->cache_visible);
     bxs_free(line->text);
     line->text = NULL;
 }
@@ -906,7 +1270,7 @@ static void free_line(line_t *line)
 static void killblank(remove_ctx_t *ctx)
 {
     size_t lines_removed = 0;
-    size_t max_lines_removable = opt.mend && !opt.killblank ? (size_t) BMAX(opt.design->padding[BTOP], 0) : SIZE_MAX;
+    size_t max_lines_removable = opt.killblank ? SIZE_MAX : (size_t) BMAX(opt.design->padding[BTOP], 0);
     while (ctx->top_end_idx < ctx->bottom_start_idx && lines_removed < max_lines_removable
             && empty_line(input.lines + ctx->top_end_idx))
     {
@@ -917,7 +1281,7 @@ static void killblank(remove_ctx_t *ctx)
     }
 
     lines_removed = 0;
-    max_lines_removable = opt.mend && !opt.killblank ? (size_t) BMAX(opt.design->padding[BBOT], 0) : SIZE_MAX;
+    max_lines_removable = opt.killblank ? SIZE_MAX : (size_t) BMAX(opt.design->padding[BBOT], 0);
     while (ctx->bottom_start_idx > ctx->top_end_idx && lines_removed < max_lines_removable
             && empty_line(input.lines + ctx->bottom_start_idx - 1))
     {
@@ -963,20 +1327,6 @@ static size_t confirmed_padding(bxstr_t *org_line, comparison_t comp_type, size_
 
 
 
-static void remove_top_from_input(remove_ctx_t *ctx)
-{
-    if (ctx->top_end_idx > ctx->top_start_idx) {
-        for (size_t j = ctx->top_start_idx; j < ctx->top_end_idx; ++j) {
-            free_line(input.lines + j);
-        }
-        memmove(input.lines + ctx->top_start_idx, input.lines + ctx->top_end_idx,
-                (input.num_lines - ctx->top_end_idx) * sizeof(line_t));
-        input.num_lines -= ctx->top_end_idx - ctx->top_start_idx;
-    }
-}
-
-
-
 static size_t calculate_start_idx(remove_ctx_t *ctx, size_t body_line_idx)
 {
     size_t input_line_idx = ctx->top_end_idx + body_line_idx;
@@ -1019,51 +1369,57 @@ static void remove_vertical_from_input(remove_ctx_t *ctx)
         size_t s_idx = calculate_start_idx(ctx, body_line_idx);
         size_t e_idx = calculate_end_idx(ctx, body_line_idx);
         log_debug(__FILE__, MAIN, "remove_vertical_from_input(): body_line_idx=%d, input_line_idx=%d, s_idx=%d, "
-                "e_idx=%d, input.indent=%d\n", (int) body_line_idx, (int) input_line_idx, (int) s_idx, (int) e_idx,
-                (int) input.indent);
+                "e_idx=%d, ctx->indent=%d\n", (int) body_line_idx, (int) input_line_idx, (int) s_idx, (int) e_idx,
+                (int) ctx->indent);
 
-        bxstr_t *temp2 = bxs_substr(org_line, s_idx, e_idx);
-        if (opt.indentmode == 'b' || opt.indentmode == '\0') {
-            /* restore indentation */
-            bxstr_t *temp = bxs_prepend_spaces(temp2, input.indent);
-            free_line_text(input.lines + input_line_idx);
-            input.lines[input_line_idx].text = temp;
-            bxs_free(temp2);
-        }
-        else {
-            /* remove indentation */
-            free_line_text(input.lines + input_line_idx);
-            input.lines[input_line_idx].text = temp2;
-        }
+        /* restore indentation, unless it is to be removed. Where the matched sides overlap, nothing remains. */
+        size_t indent = opt.indentmode == 'b' || opt.indentmode == '\0' ? ctx->indent : 0;
+        bxs_substr_inplace(org_line, BMIN(s_idx, e_idx), e_idx, indent);
     }
 }
 
 
 
-static void remove_bottom_from_input(remove_ctx_t *ctx)
+/**
+ * Remove the lines of the top and bottom sides of the box from the input, along with any blank lines killed from the
+ * body. This is done in one pass, which moves each of the remaining lines at most once.
+ * @param ctx the removal context
+ * @return the number of lines removed
+ */
+static size_t remove_top_and_bottom_from_input(remove_ctx_t *ctx)
 {
-    if (ctx->bottom_end_idx > ctx->bottom_start_idx) {
-        for (size_t j = ctx->bottom_start_idx; j < ctx->bottom_end_idx; ++j) {
+    size_t num_lines = 0;
+    for (size_t j = 0; j < input.num_lines; ++j) {
+        if ((j >= ctx->top_start_idx && j < ctx->top_end_idx)
+                || (j >= ctx->bottom_start_idx && j < ctx->bottom_end_idx))
+        {
             free_line(input.lines + j);
         }
-        if (ctx->bottom_end_idx < input.num_lines) {
-            memmove(input.lines + ctx->bottom_start_idx, input.lines + ctx->bottom_end_idx,
-                    (input.num_lines - ctx->bottom_end_idx) * sizeof(line_t));
+        else {
+            input.lines[num_lines++] = input.lines[j];
         }
-        input.num_lines -= ctx->bottom_end_idx - ctx->bottom_start_idx;
     }
+    size_t num_lines_removed = input.num_lines - num_lines;
+    memset(input.lines + num_lines, 0, num_lines_removed * sizeof(line_t));
+    input.num_lines = num_lines;
+    return num_lines_removed;
 }
 
 
 
-static void remove_default_padding(remove_ctx_t *ctx, int num_blanks)
+/**
+ * Remove the default padding from the body lines, in case the west side is open.
+ * @param ctx the removal context
+ * @param first_idx index of the first body line in `input.lines`
+ * @param num_blanks the number of blanks to remove from each body line
+ */
+static void remove_default_padding(remove_ctx_t *ctx, size_t first_idx, int num_blanks)
 {
     if (num_blanks > 0) {
         for (size_t body_line_idx = 0; body_line_idx < ctx->body_num_lines; body_line_idx++) {
-            size_t input_line_idx = ctx->top_start_idx + body_line_idx; /* top_start_idx, because top was removed! */
-            bxstr_t *temp = bxs_cut_front(input.lines[input_line_idx].text, (size_t) num_blanks);
-            free_line_text(input.lines + input_line_idx);
-            input.lines[input_line_idx].text = temp;
+            bxstr_t *text = input.lines[first_idx + body_line_idx].text;
+            size_t n = BMIN((size_t) num_blanks, text->num_chars_visible);
+            bxs_substr_inplace(text, text->first_char[n], text->num_chars, 0);
         }
         input.indent -= (size_t) num_blanks;
         input.maxline -= (size_t) num_blanks;
@@ -1075,12 +1431,8 @@ static void remove_default_padding(remove_ctx_t *ctx, int num_blanks)
 static void apply_results_to_input(remove_ctx_t *ctx)
 {
     remove_vertical_from_input(ctx);
-
-    if (opt.killblank || opt.mend) {
-        killblank(ctx);
-    }
-    remove_bottom_from_input(ctx);
-    remove_top_from_input(ctx);
+    killblank(ctx);   /* unless blank lines are killed, this removes only the design's padding */
+    size_t num_lines_removed = remove_top_and_bottom_from_input(ctx);
 
     input.maxline = 0;
     input.indent = SIZE_MAX;
@@ -1094,13 +1446,10 @@ static void apply_results_to_input(remove_ctx_t *ctx)
     }
     if (ctx->empty_side[BLEF]) {
         /* If the side were not open, default padding would have been removed when the side was removed. */
-        remove_default_padding(ctx, BMIN((int) input.indent, opt.design->padding[BLEF]));
+        /* top_start_idx, because top was removed! */
+        remove_default_padding(ctx, ctx->top_start_idx, BMIN((int) input.indent, opt.design->padding[BLEF]));
     }
 
-    size_t num_lines_removed = BMAX(ctx->top_end_idx - ctx->top_start_idx, (size_t) 0)
-            + BMAX(ctx->bottom_end_idx - ctx->bottom_start_idx, (size_t) 0);
-    memset(input.lines + input.num_lines, 0, num_lines_removed * sizeof(line_t));
-
     if (is_debug_logging(MAIN)) {
         print_input_lines(" (remove_box) after box removal");
         log_debug(__FILE__, MAIN, "Number of lines shrunk by %d.\n", (int) num_lines_removed);
@@ -1109,10 +1458,8 @@ static void apply_results_to_input(remove_ctx_t *ctx)
 
 
 
-int remove_box()
+static remove_ctx_t *new_remove_ctx()
 {
-    detect_design_if_needed();
-
     remove_ctx_t *ctx = (remove_ctx_t *) calloc(1, sizeof(remove_ctx_t));
     ctx->empty_side[BTOP] = empty_side(opt.design->shape, BTOP);
     ctx->empty_side[BRIG] = empty_side(opt.design->shape, BRIG);
@@ -1123,6 +1470,223 @@ int remove_box()
 
     ctx->design_is_mono = design_is_mono(opt.design);
     ctx->input_is_mono = input_is_mono();
+    return ctx;
+}
+
+
+
+static void free_body(remove_ctx_t *ctx)
+{
+    free_body_lines(ctx->body, ctx->body_num_lines);
+    ctx->body = NULL;
+}
+
+
+
+/**
+ * Cheap replacement for the matching of the box sides, used when the work limit was exceeded. The top and bottom sides
+ * are assumed to be as high as the corners of the design, and the vertical sides as wide, so that they can be stripped
+ * from the input without comparing anything. The west side is assumed to start at the indentation of the box, and the
+ * east side to end with the line, where trailing blanks of the east shapes have been trimmed. Blank body lines are left
+ * alone.
+ * @param ctx the removal context, whose `top_start_idx` and `bottom_end_idx` are already set. All other line indexes
+ *      and the `body` are replaced.
+ */
+static void assume_fixed_width_sides(remove_ctx_t *ctx)
+{
+    log_debug(__FILE__, MAIN, "Work limit of %d steps exceeded, falling back to fixed-width side stripping\n",
+            (int) opt.work_limit);
+    sentry_t *shapes = opt.design->shape;
+    ctx->top_end_idx = ctx->top_start_idx;
+    if (!ctx->empty_side[BTOP]) {
+        ctx->top_end_idx = BMIN(ctx->top_start_idx + shapes[NW].height, ctx->bottom_end_idx);
+    }
+    ctx->bottom_start_idx = ctx->bottom_end_idx;
+    if (!ctx->empty_side[BBOT]) {
+        ctx->bottom_start_idx = BMAX(ctx->bottom_end_idx - BMIN(shapes[SW].height, ctx->bottom_end_idx),
+                ctx->top_end_idx);
+    }
+
+    size_t east_width = 0;
+    shape_t east_shapes[] = {ENE, E, ESE};
+    for (size_t i = 0; i < sizeof(east_shapes) / sizeof(shape_t); i++) {
+        for (size_t j = 0; j < shapes[east_shapes[i]].height; j++) {
+            bxstr_t *shape_line = shapes[east_shapes[i]].mbcs[j];
+            if (!bxs_is_blank(shape_line)) {
+                east_width = BMAX(east_width, shape_line->num_chars_visible - shape_line->trailing);
+            }
+        }
+    }
+
+    free_body(ctx);
+    ctx->body_num_lines = ctx->bottom_start_idx - ctx->top_end_idx;
+    ctx->body = (line_ctx_t *) calloc(ctx->body_num_lines + 1, sizeof(line_ctx_t));
+    ctx->comp_type = ctx->input_is_mono ? literal : ignore_invisible_input;   /* indexes refer to visible chars */
+    for (size_t body_line_idx = 0; body_line_idx < ctx->body_num_lines; body_line_idx++) {
+        bxstr_t *text = input.lines[ctx->top_end_idx + body_line_idx].text;
+        line_ctx_t *lctx = ctx->body + body_line_idx;
+        if (bxs_is_blank(text)) {
+            continue;
+        }
+        size_t end_idx = text->num_chars_visible - text->trailing;
+        if (!ctx->empty_side[BLEF]) {
+            lctx->west_start = BMIN(ctx->indent, end_idx);
+            lctx->west_end = BMIN(lctx->west_start + shapes[NW].width, end_idx);
+            lctx->west_quality = lctx->west_end - lctx->west_start;
+        }
+        if (!ctx->empty_side[BRIG]) {
+            lctx->east_end = end_idx;
+            lctx->east_start = BMAX(end_idx - BMIN(east_width, end_idx), lctx->west_end);
+            lctx->east_quality = lctx->east_end - lctx->east_start;
+        }
+    }
+}
+
+
+
+/**
+ * Find the shape line which an unchanged body line was drawn with on one of the vertical sides. The shape line must
+ * occur in the body line at the given index, including its leading blanks. Since trailing blanks were trimmed from
+ * the input, the body line may end early on the east side.
+ * @param shape_lines the prepared shape lines of the vertical side
+ * @param vside the vertical side (`BLEF` or `BRIG`)
+ * @param text the body line
+ * @param start_idx index of the first character of the shape in the body line
+ * @return the length of the shape line without trailing blanks, or -1 if no shape line fits
+ */
+static long fitting_shape_line(shape_line_ctx_t **shape_lines, int vside, bxstr_t *text, size_t start_idx)
+{
+    size_t end_idx = text->num_chars - text->trailing;
+    for (shape_line_ctx_t **shape_line_ctx = shape_lines; *shape_line_ctx != NULL; shape_line_ctx++) {
+        bxstr_t *shape_line = (*shape_line_ctx)->text;
+        size_t len = bxs_is_blank(shape_line) ? 0 : shape_line->num_chars - shape_line->trailing;
+        int fits;
+        if (vside == BRIG) {
+            fits = len > 0 ? end_idx == start_idx + len : end_idx <= start_idx;
+        }
+        else {
+            fits = end_idx >= start_idx + len;
+        }
+        if (fits && (len == 0 || u32_strncmp(text->memory + start_idx, shape_line->memory, len) == 0)) {
+            return (long) len;
+        }
+    }
+    return -1;
+}
+
+
+
+/**
+ * With `--edited`, the caller tells us that the box was drawn by us, and that only the given lines of its body were
+ * changed since. Once the top and bottom sides were found, only the edited body lines are matched against the shapes
+ * of the vertical sides. On the unchanged body lines, the vertical sides are where we drew them: the west side at the
+ * indentation of the box, and the east side at the same column on every line. It is only checked that one of the
+ * shape lines is found there, which is much cheaper than matching.
+ * This requires that neither the input nor the design contain invisible characters.
+ * @param ctx the removal context, whose line indexes are already set, and whose `body` receives the results
+ * @return flag indicating that the body was processed; if false, all body lines must be matched as usual
+ */
+static int match_edited_lines_only(remove_ctx_t *ctx)
+{
+    if (opt.edited_first == 0) {
+        return 0;
+    }
+    int frame_found = (ctx->empty_side[BTOP] || ctx->top_end_idx > ctx->top_start_idx)
+            && (ctx->empty_side[BBOT] || ctx->bottom_start_idx < ctx->bottom_end_idx);
+    if (!frame_found || !ctx->input_is_mono || !ctx->design_is_mono) {
+        log_debug(__FILE__, MAIN, "Cannot rely on the box geometry, matching all body lines\n");
+        return 0;
+    }
+    size_t from_idx = BMAX(BMIN(opt.edited_first - opt.region_first, ctx->bottom_start_idx), ctx->top_end_idx);
+    size_t to_idx = BMAX(BMIN(opt.edited_last - opt.region_first + 1, ctx->bottom_start_idx), from_idx);
+
+    shape_line_ctx_t **shape_lines_west = ctx->empty_side[BLEF] ? NULL : prepare_comp_shapes_vert(BLEF, literal);
+    shape_line_ctx_t **shape_lines_east = ctx->empty_side[BRIG] ? NULL : prepare_comp_shapes_vert(BRIG, literal);
+    size_t west_width = ctx->empty_side[BLEF] ? 0 : opt.design->shape[NW].width;
+    size_t east_width = ctx->empty_side[BRIG] ? 0 : opt.design->shape[NE].width;
+
+    /* The east side starts where the longest unchanged line, plus the fewest trailing blanks of a shape line, ends. */
+    size_t min_trailing = east_width;
+    for (shape_line_ctx_t **sl = shape_lines_east; sl != NULL && *sl != NULL; sl++) {
+        if (!bxs_is_blank((*sl)->text)) {
+            min_trailing = BMIN(min_trailing, (*sl)->text->trailing);
+        }
+    }
+    size_t box_end = 0;
+    for (size_t input_line_idx = ctx->top_end_idx; input_line_idx < ctx->bottom_start_idx; input_line_idx++) {
+        if (input_line_idx < from_idx || input_line_idx >= to_idx) {
+            bxstr_t *text = input.lines[input_line_idx].text;
+            box_end = BMAX(box_end, text->num_chars - text->trailing + min_trailing);
+        }
+    }
+    size_t east_idx = box_end - BMIN(east_width, box_end);
+
+    int fits = 1;
+    size_t total_quality = 0;
+    for (size_t input_line_idx = ctx->top_end_idx; fits && input_line_idx < ctx->bottom_start_idx; input_line_idx++) {
+        bxstr_t *text = input.lines[input_line_idx].text;
+        line_ctx_t *lctx = ctx->body + (input_line_idx - ctx->top_end_idx);
+        if ((input_line_idx >= from_idx && input_line_idx < to_idx) || bxs_is_blank(text)) {
+            continue;
+        }
+        size_t end_idx = text->num_chars - text->trailing;
+        if (shape_lines_west != NULL) {
+            long len = fitting_shape_line(shape_lines_west, BLEF, text, ctx->indent);
+            fits = len >= 0 && ctx->indent + west_width <= east_idx;
+            if (len > 0) {
+                lctx->west_start = ctx->indent;
+                lctx->west_end = BMIN(ctx->indent + west_width, end_idx);
+                lctx->west_quality = lctx->west_end - lctx->west_start;
+            }
+        }
+        if (fits && shape_lines_east != NULL) {
+            long len = fitting_shape_line(shape_lines_east, BRIG, text, east_idx);
+            fits = len >= 0;
+            if (len > 0) {
+                lctx->east_start = east_idx;
+                lctx->east_end = end_idx;
+                lctx->east_quality = lctx->east_end - lctx->east_start;
+            }
+        }
+        total_quality += lctx->west_quality + lctx->east_quality;
+    }
+
+    if (fits && to_idx > from_idx) {
+        line_ctx_t *earlier_body[NUM_COMPARISON_TYPES] = {NULL};
+        body_range_t range;
+        range.ctx = ctx;
+        range.comp_type = literal;
+        range.earlier_body = earlier_body;
+        range.mono_shapes = 1;
+        range.shape_lines_west = shape_lines_west;
+        range.shape_lines_east = shape_lines_east;
+        range.from_idx = from_idx;
+        range.to_idx = to_idx;
+        total_quality += match_body_lines(&range);
+    }
+    free_shape_lines(shape_lines_west);
+    free_shape_lines(shape_lines_east);
+
+    if (!fits) {
+        log_debug(__FILE__, MAIN, "Unchanged body lines do not fit the box geometry, matching all body lines\n");
+        free_body_lines(ctx->body, ctx->body_num_lines);
+        ctx->body = (line_ctx_t *) calloc(ctx->body_num_lines, sizeof(line_ctx_t));
+        return 0;
+    }
+    log_debug(__FILE__, MAIN, "Matched edited body lines %d-%d only\n", (int) from_idx, (int) to_idx);
+    ctx->comp_type = literal;
+    sufficient_body_quality(ctx, total_quality);
+    return 1;
+}
+
+
+
+int remove_box()
+{
+    detect_design_if_needed();
+
+    remove_ctx_t *ctx = new_remove_ctx();
+    ctx->indent = input.indent;
 
     ctx->top_start_idx = find_first_line();
     if (ctx->top_start_idx >= input.num_lines) {
@@ -1153,30 +1717,426 @@ int remove_box()
 
     if (ctx->body_num_lines > 0) {
         ctx->body = (line_ctx_t *) calloc(ctx->body_num_lines, sizeof(line_ctx_t));
-        find_vertical_shapes(ctx);
+        if (!match_edited_lines_only(ctx)) {
+            find_vertical_shapes(ctx);
+        }
+    }
+    if (work_limit_exceeded(0)) {
+        assume_fixed_width_sides(ctx);
     }
 
     debug_print_remove_ctx(ctx, "before apply_results_to_input()");
     apply_results_to_input(ctx);
 
-    if (ctx->body != NULL) {
-        for (size_t i = 0; i < ctx->body_num_lines; i++) {
-            BFREE(ctx->body[i].input_line_used);
+    free_body(ctx);
+    BFREE(ctx);
+    return 0;
+}
+
+
+
+static int side_has_char(side_chars_t *side_chars, ucs4_t c)
+{
+    if (c < 128) {
+        return (side_chars->ascii[c >> 5] >> (c & 31)) & 1;
+    }
+    return side_chars->other != NULL && u32_strchr(side_chars->other, c) != NULL;
+}
+
+
+
+/**
+ * Collect the characters which occur in the shapes of a horizontal side of the current design.
+ * @param side the side, either `BTOP` or `BBOT`
+ * @param result the character set to fill
+ */
+static void collect_side_chars(int side, side_chars_t *result)
+{
+    memset(result, 0, sizeof(side_chars_t));
+    size_t num_other = 0;
+    for (size_t i = 0; i < SHAPES_PER_SIDE; i++) {
+        sentry_t *shape = opt.design->shape + sides[side][i];
+        if (isempty(shape)) {
+            continue;
+        }
+        for (size_t line_idx = 0; line_idx < shape->height; line_idx++) {
+            bxstr_t *text = shape->mbcs[line_idx];
+            for (size_t k = 0; k < text->num_chars_visible; k++) {
+                ucs4_t c = text->memory[text->visible_char[k]];
+                if (c < 128) {
+                    result->ascii[c >> 5] |= (uint32_t) 1 << (c & 31);
+                }
+                else if (!side_has_char(result, c)) {
+                    result->other = (uint32_t *) realloc(result->other, (num_other + 2) * sizeof(uint32_t));
+                    result->other[num_other++] = c;
+                    result->other[num_other] = char_nul;
+                }
+            }
         }
-        BFREE(ctx->body);
     }
+}
+
+
+
+/**
+ * Determine whether an input line could be part of a horizontal side of the box. This is the case only if all its
+ * visible characters except spaces occur in the shapes of that side. Used to reject most lines quickly.
+ * @param ctx the removal context
+ * @param side the side, either `BTOP` or `BBOT`
+ * @param line_idx index into `input.lines` of the line to check
+ * @return flag indicating that the line might match the side
+ */
+static int line_fits_side(remove_ctx_t *ctx, int side, size_t line_idx)
+{
+    bxstr_t *text = input.lines[line_idx].text;
+    for (size_t k = 0; k < text->num_chars_visible; k++) {
+        ucs4_t c = text->memory[text->visible_char[k]];
+        if (c != char_space && !side_has_char(ctx->side_chars + side, c)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+/**
+ * Create a removal context for finding multiple boxes in the input.
+ * @return a new removal context, to be freed via `free_scan_ctx()`
+ */
+static remove_ctx_t *new_scan_ctx()
+{
+    remove_ctx_t *ctx = new_remove_ctx();
+    collect_side_chars(BTOP, ctx->side_chars + BTOP);
+    collect_side_chars(BBOT, ctx->side_chars + BBOT);
+    return ctx;
+}
+
+
+
+static void free_scan_ctx(remove_ctx_t *ctx)
+{
+    BFREE(ctx->side_chars[BTOP].other);
+    BFREE(ctx->side_chars[BBOT].other);
     BFREE(ctx);
+}
+
+
+
+/**
+ * Find the bottom side of the box whose top side ends at `ctx->top_end_idx`. The first line which matches the bottom
+ * side is taken, along with any following lines which continue the match.
+ * @param ctx the removal context; on success, `bottom_start_idx` and `bottom_end_idx` are set
+ * @return flag indicating that a bottom side was found
+ */
+static int find_box_bottom(remove_ctx_t *ctx)
+{
+    size_t bottom_height = opt.design->shape[SE].height;
+    for (size_t line_idx = ctx->top_end_idx; line_idx < input.num_lines; line_idx++) {
+        if (bxs_is_blank(input.lines[line_idx].text) || !line_fits_side(ctx, BBOT, line_idx)) {
+            continue;
+        }
+        /* prefer the longest run of bottom side lines which includes this line */
+        for (size_t end_idx = BMIN(line_idx + bottom_height, input.num_lines); end_idx > line_idx; end_idx--) {
+            ctx->bottom_end_idx = end_idx;
+            size_t bottom_start_idx = find_bottom_side(ctx);
+            if (bottom_start_idx <= line_idx) {
+                ctx->bottom_start_idx = BMAX(bottom_start_idx, ctx->top_end_idx);
+                return 1;
+            }
+        }
+    }
     return 0;
 }
 
 
 
-void output_input(const int trim_only)
+/**
+ * Find a box whose top side starts at the given line. For designs without a top side, a box may start at any line;
+ * for designs without a bottom side, the box ends with the last line before a blank line.
+ * @param ctx the removal context; on success, its line indexes are set to the box found
+ * @param start_idx index of the first line of the candidate box, which is not blank
+ * @param no_bottom (IN/OUT) flag indicating that an earlier search for a bottom side reached the end of the input,
+ *      so that any later search would fail as well
+ * @return flag indicating that a box was found
+ */
+static int locate_box(remove_ctx_t *ctx, size_t start_idx, int *no_bottom)
+{
+    ctx->top_start_idx = start_idx;
+    if (ctx->empty_side[BTOP]) {
+        ctx->top_end_idx = start_idx;
+    }
+    else {
+        if (!line_fits_side(ctx, BTOP, start_idx)) {
+            return 0;
+        }
+        ctx->top_end_idx = find_top_side(ctx);
+        if (ctx->top_end_idx == start_idx) {
+            return 0;
+        }
+    }
+
+    if (ctx->empty_side[BBOT]) {
+        size_t end_idx = ctx->top_end_idx;
+        while (end_idx < input.num_lines && !bxs_is_blank(input.lines[end_idx].text)) {
+            end_idx++;
+        }
+        ctx->bottom_start_idx = end_idx;
+        ctx->bottom_end_idx = end_idx;
+        return 1;
+    }
+    if (*no_bottom || !find_box_bottom(ctx)) {
+        *no_bottom = 1;
+        return 0;
+    }
+    /* boxes always have at least one body line, so a top side directly followed by a bottom side is not a box */
+    return ctx->bottom_start_idx > ctx->top_end_idx;
+}
+
+
+
+/**
+ * Determine the indentation of the box located by `locate_box()`, which is the smallest indentation of its non-blank
+ * lines.
+ * @param ctx the removal context
+ * @return the indentation of the box
+ */
+static size_t body_indent(remove_ctx_t *ctx)
+{
+    size_t result = SIZE_MAX;
+    for (size_t line_idx = ctx->top_start_idx; line_idx < ctx->bottom_end_idx; line_idx++) {
+        bxstr_t *text = input.lines[line_idx].text;
+        if (!bxs_is_blank(text) && text->indent < result) {
+            result = text->indent;
+        }
+    }
+    return result == SIZE_MAX ? 0 : result;
+}
+
+
+
+/**
+ * Match the vertical sides of the box located by `locate_box()` against its body lines. The results are left in
+ * `ctx->body`, which must be freed by the caller.
+ * @param ctx the removal context
+ * @return flag indicating that the vertical sides matched well enough for this to be a box
+ */
+static int match_box(remove_ctx_t *ctx)
+{
+    ctx->body_num_lines = ctx->bottom_start_idx > ctx->top_end_idx ? ctx->bottom_start_idx - ctx->top_end_idx : 0;
+    ctx->indent = body_indent(ctx);
+    ctx->quality = 100;
+    int sufficient = 1;
+    if (ctx->body_num_lines > 0) {
+        ctx->body = (line_ctx_t *) calloc(ctx->body_num_lines, sizeof(line_ctx_t));
+        sufficient = find_vertical_shapes(ctx);
+    }
+    debug_print_remove_ctx(ctx, sufficient ? "box found" : "box candidate rejected");
+    return sufficient;
+}
+
+
+
+/**
+ * Match the vertical sides of the box located by `locate_box()`, and if they match well enough, strip them from the
+ * body lines. The lines of the top and bottom sides are not touched.
+ * @param ctx the removal context
+ * @return flag indicating that the vertical sides matched, so that the box was stripped
+ */
+static int strip_box(remove_ctx_t *ctx)
+{
+    int sufficient = match_box(ctx);
+    if (sufficient) {
+        remove_vertical_from_input(ctx);
+        if (opt.killblank) {
+            killblank(ctx);
+        }
+        if (ctx->empty_side[BLEF]) {
+            size_t indent = SIZE_MAX;
+            for (size_t line_idx = ctx->top_end_idx; line_idx < ctx->bottom_start_idx; line_idx++) {
+                if (!bxs_is_blank(input.lines[line_idx].text)) {
+                    indent = BMIN(indent, input.lines[line_idx].text->indent);
+                }
+            }
+            if (indent != SIZE_MAX) {
+                remove_default_padding(ctx, ctx->top_end_idx, BMIN((int) indent, opt.design->padding[BLEF]));
+            }
+        }
+    }
+    free_body(ctx);
+    ctx->body_num_lines = 0;
+    return sufficient;
+}
+
+
+
+/**
+ * Apply the reversion rules of the design to the given lines only.
+ * @param lines the result lines
+ * @param body_idx indexes into `lines` of the lines which came from box bodies
+ * @param num_body number of entries in `body_idx`
+ * @return == 0 on success; anything else on error
+ */
+static int revert_body_lines(line_t *lines, size_t *body_idx, size_t num_body)
+{
+    if (opt.design->num_revrules == 0 || num_body == 0) {
+        return 0;
+    }
+    input_t body;
+    memset(&body, 0, sizeof(input_t));
+    body.lines = (line_t *) calloc(num_body, sizeof(line_t));
+    if (body.lines == NULL) {
+        perror(PROJECT);
+        return 1;
+    }
+    body.num_lines = num_body;
+    for (size_t i = 0; i < num_body; i++) {
+        body.lines[i] = lines[body_idx[i]];
+    }
+    int rc = apply_substitutions(&body, 1);
+    for (size_t i = 0; i < num_body; i++) {
+        lines[body_idx[i]] = body.lines[i];
+    }
+    BFREE(body.lines);
+    return rc;
+}
+
+
+
+int remove_all_boxes()
+{
+    detect_design_if_needed();
+
+    remove_ctx_t *ctx = new_scan_ctx();
+    line_t *lines = (line_t *) calloc(input.num_lines + 1, sizeof(line_t));
+    size_t *body_idx = (size_t *) calloc(input.num_lines + 1, sizeof(size_t));
+    if (lines == NULL || body_idx == NULL) {
+        perror(PROJECT);
+        BFREE(lines);
+        BFREE(body_idx);
+        free_scan_ctx(ctx);
+        return 1;
+    }
+
+    size_t num_lines = 0;
+    size_t num_body = 0;
+    size_t num_boxes = 0;
+    int no_bottom = 0;
+    size_t line_idx = 0;
+    while (line_idx < input.num_lines) {
+        if (work_limit_exceeded(0)) {
+            log_debug(__FILE__, MAIN, "Work limit of %d steps exceeded, keeping lines from %d on as they are.\n",
+                    (int) opt.work_limit, (int) line_idx);
+            while (line_idx < input.num_lines) {
+                lines[num_lines++] = input.lines[line_idx++];
+            }
+            break;
+        }
+        if (bxs_is_blank(input.lines[line_idx].text) || !locate_box(ctx, line_idx, &no_bottom)) {
+            lines[num_lines++] = input.lines[line_idx++];
+            continue;
+        }
+        size_t box_end_idx = ctx->bottom_end_idx;
+        if (!strip_box(ctx)) {
+            /* Not a box after all. Its bottom side may still be the top side of the next box. */
+            size_t resume_idx = BMAX(ctx->bottom_start_idx, line_idx + 1);
+            while (line_idx < resume_idx) {
+                lines[num_lines++] = input.lines[line_idx++];
+            }
+            continue;
+        }
+
+        log_debug(__FILE__, MAIN, "Removing box from lines %d to %d.\n", (int) ctx->top_start_idx,
+                (int) box_end_idx - 1);
+        for (size_t i = ctx->top_start_idx; i < box_end_idx; i++) {
+            if (i >= ctx->top_end_idx && i < ctx->bottom_start_idx) {
+                body_idx[num_body++] = num_lines;
+                lines[num_lines++] = input.lines[i];
+            }
+            else {
+                free_line(input.lines + i);
+            }
+        }
+        line_idx = box_end_idx;
+        num_boxes++;
+    }
+    log_debug(__FILE__, MAIN, "Removed %d boxes.\n", (int) num_boxes);
+
+    BFREE(input.lines);
+    input.lines = lines;
+    input.num_lines = num_lines;
+    input.maxline = 0;
+    input.indent = SIZE_MAX;
+    for (size_t j = 0; j < input.num_lines; ++j) {
+        input.maxline = BMAX(input.maxline, input.lines[j].text->num_columns);
+        input.indent = BMIN(input.indent, input.lines[j].text->indent);
+    }
+
+    int rc = revert_body_lines(lines, body_idx, num_body);
+    BFREE(body_idx);
+    free_scan_ctx(ctx);
+    return rc;
+}
+
+
+
+box_location_t *find_all_boxes(size_t *num_boxes)
+{
+    *num_boxes = 0;
+    remove_ctx_t *ctx = new_scan_ctx();
+    box_location_t *result = NULL;
+    size_t capacity = 0;
+
+    int no_bottom = 0;
+    size_t line_idx = 0;
+    while (line_idx < input.num_lines) {
+        if (work_limit_exceeded(0)) {
+            log_debug(__FILE__, MAIN, "Work limit of %d steps exceeded, not looking for boxes from line %d on.\n",
+                    (int) opt.work_limit, (int) line_idx);
+            break;
+        }
+        if (bxs_is_blank(input.lines[line_idx].text) || !locate_box(ctx, line_idx, &no_bottom)) {
+            line_idx++;
+            continue;
+        }
+        int sufficient = match_box(ctx);
+        free_body(ctx);
+        ctx->body_num_lines = 0;
+        if (!sufficient) {
+            line_idx = BMAX(ctx->bottom_start_idx, line_idx + 1);
+            continue;
+        }
+
+        if (*num_boxes == capacity) {
+            capacity = capacity == 0 ? 16 : 2 * capacity;
+            result = (box_location_t *) realloc(result, capacity * sizeof(box_location_t));
+            if (result == NULL) {
+                perror(PROJECT);
+                free_scan_ctx(ctx);
+                *num_boxes = 0;
+                return NULL;
+            }
+        }
+        result[*num_boxes].start_idx = ctx->top_start_idx;
+        result[*num_boxes].end_idx = ctx->bottom_end_idx;
+        result[*num_boxes].quality = ctx->quality;
+        (*num_boxes)++;
+        line_idx = ctx->bottom_end_idx;
+    }
+    log_debug(__FILE__, MAIN, "Found %d boxes.\n", (int) *num_boxes);
+
+    free_scan_ctx(ctx);
+    return result;
+}
+
+
+
+void output_input()
 {
     size_t indent;
     int ntabs, nspcs;
 
-    log_debug(__FILE__, MAIN, "output_input() - enter (trim_only=%d)\n", trim_only);
+    log_debug(__FILE__, MAIN, "output_input() - enter\n");
 
     for (size_t j = 0; j < input.num_lines; ++j) {
         if (input.lines[j].text == NULL) {
@@ -1185,9 +2145,6 @@ void output_input(const int trim_only)
         bxstr_t *temp = bxs_rtrim(input.lines[j].text);
         bxs_free(input.lines[j].text);
         input.lines[j].text = temp;
-        if (trim_only) {
-            continue;
-        }
 
         char *indentspc = NULL;
         if (opt.tabexp == 'u') {
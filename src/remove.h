@@ -53,19 +53,52 @@ typedef struct _shape_line_ctx_t {
 
 
 /**
- * Remove box from input.
+ * Remove box from input. When the work limit (`--work-limit`) is exceeded, the sides of the box are no longer matched,
+ * but stripped according to the size of the corners of the design.
  * @return == 0: success;
  *         \!= 0:  error
  */
 int remove_box();
 
 
+/**
+ * Remove all boxes from input, leaving the lines between boxes as they are. Boxes are found by their top and bottom
+ * sides; a candidate is only removed if its body lines also match the vertical sides. When the work limit
+ * (`--work-limit`) is exceeded, the remaining lines are left as they are.
+ * @return == 0: success;
+ *         \!= 0:  error
+ */
+int remove_all_boxes();
+
+
+/** the position of a box in the input, as found by `find_all_boxes()` */
+typedef struct _box_location_t {
+    /** index into `input.lines` of the first line of the box */
+    size_t start_idx;
+
+    /** index into `input.lines` of the line following the last line of the box */
+    size_t end_idx;
+
+    /** match quality of the vertical sides of the box, in percent of the best possible match */
+    int quality;
+} box_location_t;
+
+
+
+/**
+ * Find all boxes of the current design (`opt.design`) in the input, without changing the input. Boxes are found in
+ * the same way as by `remove_all_boxes()`.
+ * @param num_boxes (OUT) the number of boxes found
+ * @return the positions of the boxes found, in order; NULL if none were found. The caller must free the result.
+ */
+box_location_t *find_all_boxes(size_t *num_boxes);
+
+
 /**
  * Output contents of input line list "as is" to standard output, except for removal of trailing spaces (trimming).
  * The trimming is performed on the actual input lines, modifying them.
- * @param trim_only only perform the trimming of trailing spaces, but do not output anything
  */
-void output_input(const int trim_only);
+void output_input();
 
 
 #endif /*REMOVE_H*/
@@ -30,6 +30,9 @@
 #include <unistr.h>
 #include <unitypes.h>
 #include <uniwidth.h>
+#ifndef __MINGW32__
+    #include <unistd.h>
+#endif
 
 #include "boxes.h"
 #include "logging.h"
@@ -362,9 +365,7 @@ size_t my_strrspn(const char *s, const char *accept)
 
 uint32_t *tabbify_indent(const size_t lineno, uint32_t *indentspc, const size_t indentspc_len)
 {
-    size_t i;
     uint32_t *result;
-    size_t result_len;
 
     if (opt.tabexp != 'k') {
         return indentspc;
@@ -381,8 +382,20 @@ uint32_t *tabbify_indent(const size_t lineno, uint32_t *indentspc, const size_t
         perror(PROJECT);
         return NULL;
     }
-    u32_set(result, char_space, indentspc_len);
-    set_char_at(result, indentspc_len, char_nul);
+    tabbify_indent_to(lineno, indentspc_len, result);
+
+    return result;
+}
+
+
+
+size_t tabbify_indent_to(const size_t lineno, const size_t indentspc_len, uint32_t *dest)
+{
+    size_t i;
+    size_t result_len;
+
+    u32_set(dest, char_space, indentspc_len);
+    set_char_at(dest, indentspc_len, char_nul);
     result_len = indentspc_len;
 
     for (i = 0; i < input.lines[lineno].tabpos_len && input.lines[lineno].tabpos[i] < indentspc_len; ++i) {
@@ -391,12 +404,12 @@ uint32_t *tabbify_indent(const size_t lineno, uint32_t *indentspc, const size_t
         if (tpos + nspc > input.indent) {
             break;
         }
-        set_char_at(result, tpos, char_tab);
+        set_char_at(dest, tpos, char_tab);
         result_len -= nspc - 1;
-        set_char_at(result, result_len, char_nul);
+        set_char_at(dest, result_len, char_nul);
     }
 
-    return result;
+    return result_len;
 }
 
 
@@ -732,4 +745,27 @@ FILE *bx_fopen(char *pathname, char *mode)
 }
 
 
+
+size_t num_worker_threads(size_t num_items, size_t min_items_per_thread, size_t max_threads)
+{
+    #ifdef __MINGW32__
+        UNUSED(num_items);
+        UNUSED(min_items_per_thread);
+        UNUSED(max_threads);
+        return 1;
+    #else
+        if (is_debug_logging(MAIN)) {
+            return 1;  /* keep the debug output in order */
+        }
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        size_t result = num_items / min_items_per_thread;
+        result = BMIN(result, max_threads);
+        if (num_cpus > 0) {
+            result = BMIN(result, (size_t) num_cpus);
+        }
+        return BMAX(result, (size_t) 1);
+    #endif
+}
+
+
 /* vim: set sw=4: */
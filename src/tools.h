@@ -143,6 +143,18 @@ char *repeat(char *s, size_t count);
 uint32_t *tabbify_indent(const size_t lineno, uint32_t *indentspc, const size_t indentspc_len);
 
 
+/**
+ * Write the indentation of an input line to the given buffer, with tabs in their original positions like
+ * `tabbify_indent()` does when tab expansion mode is "keep", but without allocating memory.
+ *
+ * @param lineno index of the input line we are referring to
+ * @param indentspc_len desired result length, measured in spaces only
+ * @param dest the buffer to write to, which must have room for `indentspc_len + 1` characters
+ * @return the number of characters written to `dest`, not counting the terminating NUL
+ */
+size_t tabbify_indent_to(const size_t lineno, const size_t indentspc_len, uint32_t *dest);
+
+
 char *nspaces(const size_t n);
 
 
@@ -265,6 +277,18 @@ FILE *bx_fopens(bxstr_t *pathname, char *mode);
 FILE *bx_fopen(char *pathname, char *mode);
 
 
+/**
+ * Determine how many worker threads to use for processing a number of items in parallel. Every thread gets at least
+ * `min_items_per_thread` items, and no more threads are used than there are processors. When debug logging is active,
+ * or on platforms without thread support, only one thread is used.
+ * @param num_items the number of items to process
+ * @param min_items_per_thread the minimum number of items worth a thread of its own
+ * @param max_threads the maximum number of threads to use
+ * @return the number of threads to use, at least 1
+ */
+size_t num_worker_threads(size_t num_items, size_t min_items_per_thread, size_t max_threads);
+
+
 #endif
 
 /* vim: set cindent sw=4: */
@@ -22,6 +22,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 #include <uniconv.h>
 #include <unictype.h>
@@ -213,6 +219,16 @@ uint32_t *u32_strconv_from_input(const char *src)
 
 
 
+int is_ascii_superset(const char *enc)
+{
+    return strcasecmp(enc, "UTF-8") == 0 || strcasecmp(enc, "ASCII") == 0 || strcasecmp(enc, "US-ASCII") == 0
+            || strcasecmp(enc, "ANSI_X3.4-1968") == 0 || strncasecmp(enc, "ISO-8859-", 9) == 0
+            || strncasecmp(enc, "ISO8859-", 8) == 0 || strncasecmp(enc, "CP125", 5) == 0
+            || strncasecmp(enc, "WINDOWS-125", 11) == 0;
+}
+
+
+
 uint32_t *u32_strconv_from_arg(const char *src, const char *sourceEncoding)
 {
     if (src == NULL) {
@@ -222,6 +238,22 @@ uint32_t *u32_strconv_from_arg(const char *src, const char *sourceEncoding)
         return new_empty_string32();
     }
 
+    size_t ascii_len = 0;
+    while (src[ascii_len] != '\0' && (unsigned char) src[ascii_len] < 0x80) {
+        ascii_len++;
+    }
+    if (src[ascii_len] == '\0' && is_ascii_superset(sourceEncoding)) {
+        uint32_t *result = (uint32_t *) malloc((ascii_len + 1) * sizeof(uint32_t));
+        if (result == NULL) {
+            perror(PROJECT);
+            return NULL;
+        }
+        for (size_t i = 0; i <= ascii_len; i++) {
+            result[i] = (unsigned char) src[i];
+        }
+        return result;
+    }
+
     uint32_t *result = u32_strconv_from_encoding(
             src,                    /* the source string to convert */
             sourceEncoding,         /* the character encoding from which to convert */
@@ -242,6 +274,37 @@ char *u32_strconv_to_output(const uint32_t *src)
 
 
 
+size_t u32_conv_to_output_buf(const uint32_t *src, const size_t srclen, char **buf, size_t *bufsize)
+{
+    size_t length = *bufsize;
+    char *result = NULL;
+    if (strcasecmp(encoding, "UTF-8") == 0) {
+        /* direct conversion, because the general one below would allocate temporary memory on every call */
+        result = (char *) u32_to_u8(src, srclen, (uint8_t *) *buf, &length);
+    }
+    if (result == NULL) {
+        length = *bufsize;
+        result = u32_conv_to_encoding(
+                encoding,               /* the character encoding to which to convert */
+                iconveh_question_mark,  /* produce one question mark '?' per unconvertible character */
+                src, srclen, NULL,      /* the source string to convert, no offsets needed */
+                *buf, &length);         /* try to reuse the buffer */
+    }
+
+    if (result == NULL) {
+        fprintf(stderr, "%s: failed to convert from UTF-32 to '%s': %s\n", PROJECT, encoding, strerror(errno));
+        return (size_t) -1;
+    }
+    if (result != *buf) {
+        BFREE(*buf);
+        *buf = result;
+        *bufsize = length;
+    }
+    return length;
+}
+
+
+
 char *u32_strconv_to_arg(const uint32_t *src, const char *targetEncoding)
 {
     if (src == NULL) {
@@ -315,32 +378,143 @@ uint32_t *u32_nspaces(const size_t n)
 
 
 
-uint32_t *u32_strnrstr(const uint32_t *haystack, const uint32_t *needle, const size_t needle_len)
+#if defined(__AVX2__)
+    #define U32_VECTOR_WIDTH 8
+#elif defined(__SSE2__)
+    #define U32_VECTOR_WIDTH 4
+#endif
+
+#ifdef U32_VECTOR_WIDTH
+
+/**
+ * Compare a block of `U32_VECTOR_WIDTH` candidate match positions against the first and the last character of the
+ * needle at once. The caller guarantees that `p[0 .. U32_VECTOR_WIDTH-1]` and
+ * `p[last_offset .. last_offset+U32_VECTOR_WIDTH-1]` are within the haystack.
+ * @param p the first candidate position
+ * @param last_offset offset of the needle's last character from its first (needle length minus one)
+ * @param first the first character of the needle
+ * @param last the last character of the needle
+ * @return bit mask with bit `i` set if position `p + i` matches both the first and the last needle character
+ */
+static unsigned candidate_mask(const uint32_t *p, const size_t last_offset, const uint32_t first, const uint32_t last)
 {
-    if (is_empty(needle)) {
+    #if defined(__AVX2__)
+        __m256i eq = _mm256_and_si256(
+                _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) p), _mm256_set1_epi32((int) first)),
+                _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (p + last_offset)),
+                        _mm256_set1_epi32((int) last)));
+        return (unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+    #else
+        __m128i eq = _mm_and_si128(
+                _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) p), _mm_set1_epi32((int) first)),
+                _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (p + last_offset)), _mm_set1_epi32((int) last)));
+        return (unsigned) _mm_movemask_ps(_mm_castsi128_ps(eq));
+    #endif
+}
+
+#endif
+
+
+
+uint32_t *u32_find_first(const uint32_t *haystack, const size_t haystack_len,
+        const uint32_t *needle, const size_t needle_len)
+{
+    if (haystack == NULL) {
+        return NULL;
+    }
+    if (needle == NULL || needle_len == 0) {
         return (uint32_t *) haystack;
     }
-    if (is_empty(haystack)) {
+    if (needle_len > haystack_len) {
         return NULL;
     }
 
-    uint32_t *p = u32_strrchr(haystack, needle[0]);
-    if (!p) {
+    const size_t last_start = haystack_len - needle_len;
+    const size_t last_offset = needle_len - 1;
+    size_t i = 0;
+
+    #ifdef U32_VECTOR_WIDTH
+        for (; i + U32_VECTOR_WIDTH - 1 <= last_start; i += U32_VECTOR_WIDTH) {
+            unsigned mask = candidate_mask(haystack + i, last_offset, needle[0], needle[last_offset]);
+            while (mask != 0) {
+                size_t candidate = i + (size_t) __builtin_ctz(mask);
+                if (needle_len <= 2 || u32_cmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0) {
+                    return (uint32_t *) (haystack + candidate);
+                }
+                mask &= mask - 1;
+            }
+        }
+    #endif
+
+    for (; i <= last_start; i++) {
+        if (haystack[i] == needle[0] && haystack[i + last_offset] == needle[last_offset]
+                && (needle_len <= 2 || u32_cmp(haystack + i + 1, needle + 1, needle_len - 2) == 0)) {
+            return (uint32_t *) (haystack + i);
+        }
+    }
+    return NULL;
+}
+
+
+
+uint32_t *u32_find_last(const uint32_t *haystack, const size_t haystack_len,
+        const uint32_t *needle, const size_t needle_len)
+{
+    if (haystack == NULL) {
+        return NULL;
+    }
+    if (needle == NULL || needle_len == 0) {
+        return (uint32_t *) (haystack + haystack_len);
+    }
+    if (needle_len > haystack_len) {
         return NULL;
     }
 
-    while (p >= haystack) {
-        if (u32_strncmp(p, needle, needle_len) == 0) {
-            return p;
+    /* candidate match positions still to check are `0 .. remaining-1`, checked from right to left */
+    size_t remaining = haystack_len - needle_len + 1;
+    const size_t last_offset = needle_len - 1;
+
+    #ifdef U32_VECTOR_WIDTH
+        while (remaining >= U32_VECTOR_WIDTH) {
+            size_t block = remaining - U32_VECTOR_WIDTH;
+            unsigned mask = candidate_mask(haystack + block, last_offset, needle[0], needle[last_offset]);
+            while (mask != 0) {
+                unsigned bit = (unsigned) (31 - __builtin_clz(mask));
+                size_t candidate = block + bit;
+                if (needle_len <= 2 || u32_cmp(haystack + candidate + 1, needle + 1, needle_len - 2) == 0) {
+                    return (uint32_t *) (haystack + candidate);
+                }
+                mask &= ~(1u << bit);
+            }
+            remaining = block;
         }
-        --p;
-    }
+    #endif
 
+    while (remaining > 0) {
+        size_t i = --remaining;
+        if (haystack[i] == needle[0] && haystack[i + last_offset] == needle[last_offset]
+                && (needle_len <= 2 || u32_cmp(haystack + i + 1, needle + 1, needle_len - 2) == 0)) {
+            return (uint32_t *) (haystack + i);
+        }
+    }
     return NULL;
 }
 
 
 
+uint32_t *u32_strnrstr(const uint32_t *haystack, const uint32_t *needle, const size_t needle_len)
+{
+    if (is_empty(needle)) {
+        return (uint32_t *) haystack;
+    }
+    if (is_empty(haystack)) {
+        return NULL;
+    }
+    return u32_find_last(haystack, u32_strlen(haystack), needle, needle_len);
+}
+
+
+
 void u32_insert_space_at(uint32_t **s, const size_t idx, const size_t n)
 {
     if (s == NULL || n == 0) {
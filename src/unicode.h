@@ -173,6 +173,15 @@ uint32_t *u32_strconv_from_input(const char *src);
 uint32_t *u32_strconv_from_arg(const char *src, const char *sourceEncoding);
 
 
+/**
+ * Determine if an encoding represents all ASCII characters as single bytes of the same value, so that pure ASCII text
+ * in this encoding can be converted without calling iconv. Only well-known encodings are considered.
+ * @param enc the name of the encoding
+ * @return flag (1 or 0)
+ */
+int is_ascii_superset(const char *enc);
+
+
 /**
  * Convert a string from UTF-32 internal representation to input/output encoding (`encoding` in this .h file).
  * Memory will be allocated for the converted string.
@@ -183,6 +192,20 @@ uint32_t *u32_strconv_from_arg(const char *src, const char *sourceEncoding);
 char *u32_strconv_to_output(const uint32_t *src);
 
 
+/**
+ * Convert a string from UTF-32 internal representation to input/output encoding (`encoding` in this .h file),
+ * reusing the given buffer. A larger buffer replaces it only when the result does not fit.
+ *
+ * @param src UTF-32 string to convert, need not be zero-terminated
+ * @param srclen number of characters in `src` to convert
+ * @param buf (IN/OUT) pointer to a buffer allocated on the heap, or pointer to NULL
+ * @param bufsize (IN/OUT) size of `*buf` in bytes
+ * @return the number of bytes in `*buf`, which is not zero-terminated, or `(size_t) -1` on error (then an error
+ *      message was already printed on stderr)
+ */
+size_t u32_conv_to_output_buf(const uint32_t *src, const size_t srclen, char **buf, size_t *bufsize);
+
+
 /**
  * Convert a string from UTF-32 internal representation to the given target encoding.
  * Memory will be allocated for the converted string.
@@ -223,6 +246,36 @@ char *to_utf8(uint32_t *src);
 uint32_t *u32_nspaces(const size_t n);
 
 
+/**
+ * Return pointer to the first occurrence of string `needle` in string `haystack`. Both strings are given with their
+ * lengths, so they need not be NUL-terminated, and the search never reads beyond `haystack_len`. Vectorized where
+ * the compiler target supports it.
+ * @param haystack string to search
+ * @param haystack_len length in characters of `haystack`
+ * @param needle string to search for in `haystack`
+ * @param needle_len length in characters of `needle`
+ * @return pointer to first occurrence of `needle` in `haystack`; `haystack` if `needle` is empty; NULL if not found
+ *      or `haystack` is NULL
+ */
+uint32_t *u32_find_first(const uint32_t *haystack, const size_t haystack_len,
+        const uint32_t *needle, const size_t needle_len);
+
+
+/**
+ * Return pointer to the last occurrence of string `needle` in string `haystack`. Both strings are given with their
+ * lengths, so they need not be NUL-terminated, and the search never reads beyond `haystack_len`. Vectorized where
+ * the compiler target supports it.
+ * @param haystack string to search
+ * @param haystack_len length in characters of `haystack`
+ * @param needle string to search for in `haystack`
+ * @param needle_len length in characters of `needle`
+ * @return pointer to last occurrence of `needle` in `haystack`; the end of `haystack` if `needle` is empty; NULL if
+ *      not found or `haystack` is NULL
+ */
+uint32_t *u32_find_last(const uint32_t *haystack, const size_t haystack_len,
+        const uint32_t *needle, const size_t needle_len);
+
+
 /**
  * Return pointer to last occurrence of string `needle` in string `haystack`.
  * @param haystack string to search
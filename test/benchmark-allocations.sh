@@ -0,0 +1,143 @@
+#!/usr/bin/env bash
+#
+# boxes - Command line filter to draw/remove ASCII boxes around text
+# Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+#
+# This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+# License, version 3, as published by the Free Software Foundation.
+# This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+# You should have received a copy of the GNU General Public License along with this program.
+# If not, see <https://www.gnu.org/licenses/>.
+#____________________________________________________________________________________________________________________
+#
+# Counts the heap allocations made while removing large boxes. A small library which counts the calls to malloc(),
+# calloc() and realloc() is built on the fly and preloaded via LD_PRELOAD, so this works only with glibc. The number
+# of allocations per line of input should be small and stay the same for all box sizes; in particular, matching the
+# shapes against a line must not allocate memory for every candidate which is tried.
+#____________________________________________________________________________________________________________________
+
+set -uo pipefail
+
+# Global constants
+declare -r OUT_DIR=../out
+declare -r -a LINE_COUNTS=(1000 10000 100000)
+declare -r -a DESIGNS=(c parchment dog ian_jones)
+declare -r LINE_TEXT="The quick brown fox jumps over the lazy dog, again and again and again."
+
+
+
+function check_prereqs()
+{
+    if [ "${PWD##*/}" != "test" ]; then
+        >&2 echo "Please run this script from the test folder."
+        exit 2
+    fi
+    if [ ! -d ${OUT_DIR} ]; then
+        >&2 echo "Please run 'make' from the project root to build an executable before running benchmarks."
+        exit 2
+    fi
+}
+
+
+function get_executable_name()
+{
+    local binaryName=${OUT_DIR}/boxes.exe
+    if [ ! -x "$binaryName" ]; then
+        binaryName=${OUT_DIR}/boxes
+    fi
+    echo $binaryName
+}
+
+
+function build_counter()
+# Args: $1 - shared library to build
+{
+    local sourceFile="$1.c"
+    cat > "${sourceFile}" <<'END_OF_SOURCE'
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long num_allocations = 0;
+
+void *malloc(size_t size)
+{
+    ++num_allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    ++num_allocations;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    ++num_allocations;
+    return __libc_realloc(ptr, size);
+}
+
+__attribute__((destructor)) static void report(void)
+{
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%lu\n", num_allocations);
+    if (write(STDERR_FILENO, buf, (size_t) len) < 0) {
+        _exit(1);
+    }
+}
+END_OF_SOURCE
+    ${CC:-cc} -shared -fPIC -O -o "$1" "${sourceFile}"
+}
+
+
+function count_allocations()
+# Args: $1 - design
+#       $2 - input file
+{
+    LD_PRELOAD="${counterLib}" ${boxesBinary} -f ../boxes-config -d "$1" -r "$2" 2>&1 > /dev/null | tail -n 1
+}
+
+
+check_prereqs
+
+declare boxesBinary
+boxesBinary=$(get_executable_name)
+
+declare workDir
+workDir=$(mktemp -d)
+trap 'rm -rf "${workDir}"' EXIT
+declare -r counterLib=${workDir}/alloc-counter.so
+declare -r inputFile=${workDir}/input.txt
+
+if ! build_counter "${counterLib}" || [ -z "$(LD_PRELOAD="${counterLib}" ${boxesBinary} -v 2>&1 >/dev/null)" ]; then
+    >&2 echo "Allocations can only be counted with glibc and a C compiler. Skipping."
+    exit 0
+fi
+
+echo "Number of heap allocations to remove a box around the given number of lines"
+printf "%-12s" "design"
+for count in "${LINE_COUNTS[@]}"; do
+    printf "%10d" "${count}"
+done
+printf "%12s\n" "per line"
+
+for design in "${DESIGNS[@]}"; do
+    printf "%-12s" "${design}"
+    allocations=0
+    for count in "${LINE_COUNTS[@]}"; do
+        yes "${LINE_TEXT}" | head -n "${count}" | ${boxesBinary} -f ../boxes-config -d "${design}" > "${inputFile}"
+        allocations=$(count_allocations "${design}" "${inputFile}")
+        printf "%10d" "${allocations}"
+    done
+    printf "%12d\n" $(( allocations / ${LINE_COUNTS[-1]} ))
+done
+
+exit 0
@@ -0,0 +1,112 @@
+#!/usr/bin/env bash
+#
+# boxes - Command line filter to draw/remove ASCII boxes around text
+# Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+#
+# This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+# License, version 3, as published by the Free Software Foundation.
+# This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+# You should have received a copy of the GNU General Public License along with this program.
+# If not, see <https://www.gnu.org/licenses/>.
+#____________________________________________________________________________________________________________________
+#
+# Compares drawing boxes around pure ASCII text, whose lines are composed as byte strings, with the general line
+# composer working on UTF-32, which is forced by setting BOXES_GENERAL_COMPOSER. The output of both must be the same.
+# The designs are pure ASCII, too; 'c' and 'shell' also take the fast path for simple sides, 'dog' and 'parchment' do
+# not.
+#____________________________________________________________________________________________________________________
+
+set -uo pipefail
+
+# Global constants
+declare -r OUT_DIR=../out
+declare -r -a LINE_COUNTS=(10000 100000 300000)
+declare -r -a DESIGNS=(c shell dog parchment)
+declare -r LINE_TEXT="The quick brown fox jumps over the lazy dog, again and again and again."
+
+
+
+function check_prereqs()
+{
+    if [ "${PWD##*/}" != "test" ]; then
+        >&2 echo "Please run this script from the test folder."
+        exit 2
+    fi
+    if [ ! -d ${OUT_DIR} ]; then
+        >&2 echo "Please run 'make' from the project root to build an executable before running benchmarks."
+        exit 2
+    fi
+}
+
+
+function get_executable_name()
+{
+    local binaryName=${OUT_DIR}/boxes.exe
+    if [ ! -x "$binaryName" ]; then
+        binaryName=${OUT_DIR}/boxes
+    fi
+    echo $binaryName
+}
+
+
+function measure_millis()
+# Args: $1 - design
+#       $2 - input file
+#       $3 - output file
+#       $4 - "general" to force the general line composer
+{
+    local start end
+    start=$(date +%s%N)
+    if [ "$4" == "general" ]; then
+        BOXES_GENERAL_COMPOSER=1 ${boxesBinary} -n UTF-8 -f ../boxes-config -d "$1" "$2" "$3"
+    else
+        ${boxesBinary} -n UTF-8 -f ../boxes-config -d "$1" "$2" "$3"
+    fi
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+
+check_prereqs
+
+declare boxesBinary
+boxesBinary=$(get_executable_name)
+
+declare inputFile bytesFile generalFile
+inputFile=$(mktemp)
+bytesFile=$(mktemp)
+generalFile=$(mktemp)
+trap 'rm -f "${inputFile}" "${bytesFile}" "${generalFile}"' EXIT
+
+echo "Time in milliseconds to draw a box around the given number of lines, byte strings / general composer"
+printf "%-14s" "design"
+for count in "${LINE_COUNTS[@]}"; do
+    printf "%16d" "${count}"
+done
+echo
+
+declare -A millis
+for count in "${LINE_COUNTS[@]}"; do
+    yes "${LINE_TEXT}" | head -n "${count}" > "${inputFile}"
+    for design in "${DESIGNS[@]}"; do
+        bytes=$(measure_millis "${design}" "${inputFile}" "${bytesFile}" bytes)
+        general=$(measure_millis "${design}" "${inputFile}" "${generalFile}" general)
+        if ! cmp -s "${bytesFile}" "${generalFile}"; then
+            >&2 echo "Output of design ${design} differs between byte strings and the general composer."
+            exit 1
+        fi
+        millis[${design},${count}]="${bytes} / ${general}"
+    done
+done
+
+for design in "${DESIGNS[@]}"; do
+    printf "%-14s" "${design}"
+    for count in "${LINE_COUNTS[@]}"; do
+        printf "%16s" "${millis[${design},${count}]}"
+    done
+    echo
+done
+
+exit 0
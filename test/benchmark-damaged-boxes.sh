@@ -0,0 +1,132 @@
+#!/usr/bin/env bash
+#
+# boxes - Command line filter to draw/remove ASCII boxes around text
+# Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+#
+# This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+# License, version 3, as published by the Free Software Foundation.
+# This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+# You should have received a copy of the GNU General Public License along with this program.
+# If not, see <https://www.gnu.org/licenses/>.
+#____________________________________________________________________________________________________________________
+#
+# Measures the time needed to remove wide boxes whose top line is damaged just before the right corner, so that it
+# does not match. The 'dashes' design, which is added to the config for this benchmark, has two elastic shapes in its
+# top line made of the same character as the shape between them, so every split of the line between them must be
+# tried before the match fails. The time should grow linearly with the width of the box, for all designs.
+#____________________________________________________________________________________________________________________
+
+set -uo pipefail
+
+# Global constants
+declare -r OUT_DIR=../out
+declare -r -a BOX_WIDTHS=(1000 5000 20000 50000)
+declare -r -a DESIGNS=(dashes c dog ian_jones)
+
+
+
+function check_prereqs()
+{
+    if [ "${PWD##*/}" != "test" ]; then
+        >&2 echo "Please run this script from the test folder."
+        exit 2
+    fi
+    if [ ! -d ${OUT_DIR} ]; then
+        >&2 echo "Please run 'make' from the project root to build an executable before running benchmarks."
+        exit 2
+    fi
+}
+
+
+function get_executable_name()
+{
+    local binaryName=${OUT_DIR}/boxes.exe
+    if [ ! -x "$binaryName" ]; then
+        binaryName=${OUT_DIR}/boxes
+    fi
+    echo $binaryName
+}
+
+
+function write_config()
+# Args: $1 - config file to write
+{
+    cat ../boxes-config > "$1"
+    cat >> "$1" <<'END_OF_DESIGN'
+
+BOX dashes
+
+sample
+    +------+
+    |      |
+    +------+
+ends
+
+shapes {
+    nw ("+") nnw ("-") n ("--") nne ("-") ne ("+")
+     w ("|")                               e ("|")
+    sw ("+")            s ("-")            se ("+")
+}
+
+elastic (nnw, nne, s, e, w)
+
+END dashes
+END_OF_DESIGN
+}
+
+
+function damage_top_line()
+# Args: $1 - file with a box, whose first line starting with a non-blank character is damaged in place
+{
+    local lineNo
+    lineNo=$(awk '/^[^ ]/ {print NR; exit}' "$1")
+    awk -v n="${lineNo}" 'NR == n {l = length($0); $0 = substr($0, 1, l - 2) "x" substr($0, l)} {print}' "$1" \
+        > "$1.damaged"
+    mv "$1.damaged" "$1"
+}
+
+
+function measure_millis()
+# Args: $1 - design
+#       $2 - input file
+{
+    local start end
+    start=$(date +%s%N)
+    ${boxesBinary} -f "${configFile}" -d "$1" -r "$2" > /dev/null
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+
+check_prereqs
+
+declare boxesBinary
+boxesBinary=$(get_executable_name)
+
+declare configFile inputFile
+configFile=$(mktemp)
+inputFile=$(mktemp)
+trap 'rm -f "${configFile}" "${inputFile}"' EXIT
+write_config "${configFile}"
+
+echo "Time in milliseconds to remove a box of the given width with a damaged top line"
+printf "%-12s" "design"
+for width in "${BOX_WIDTHS[@]}"; do
+    printf "%10d" "${width}"
+done
+echo
+
+for design in "${DESIGNS[@]}"; do
+    printf "%-12s" "${design}"
+    for width in "${BOX_WIDTHS[@]}"; do
+        yes "The quick brown fox jumps over the lazy dog." | head -n 3 \
+            | ${boxesBinary} -f "${configFile}" -d "${design}" -s "${width}" > "${inputFile}"
+        damage_top_line "${inputFile}"
+        printf "%10d" "$(measure_millis "${design}" "${inputFile}")"
+    done
+    echo
+done
+
+exit 0
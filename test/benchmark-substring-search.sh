@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+#
+# boxes - Command line filter to draw/remove ASCII boxes around text
+# Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+#
+# This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+# License, version 3, as published by the Free Software Foundation.
+# This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+# You should have received a copy of the GNU General Public License along with this program.
+# If not, see <https://www.gnu.org/licenses/>.
+#____________________________________________________________________________________________________________________
+#
+# Measures the UTF-32 substring search used to find shapes in the lines of a box. The forward search u32_find_first()
+# is compared with u32_strstr() from libunistring, which it replaced, and the backward search u32_find_last() with
+# the former implementation of u32_strnrstr(). Each line holds one shape at the far end from where the search starts,
+# plus some partial matches of it. The same number of characters is searched for every line length, so the times
+# should be about the same across a row, and lower for the new functions.
+# The search_benchmark executable is built by 'make benchmark'.
+#____________________________________________________________________________________________________________________
+
+set -uo pipefail
+
+# Global constants
+declare -r OUT_DIR=../out
+declare -r -a SHAPE_LENGTHS=(1 2 4 8 16)
+declare -r -a LINE_LENGTHS=(20 80 400 2000)
+declare -r -a FUNCTIONS=(strstr find_first strnrstr find_last)
+
+
+
+function check_prereqs()
+{
+    if [ "${PWD##*/}" != "test" ]; then
+        >&2 echo "Please run this script from the test folder."
+        exit 2
+    fi
+    if [ ! -x ${OUT_DIR}/search_benchmark ]; then
+        >&2 echo "Please run 'make benchmark' from the project root to build the search benchmark."
+        exit 2
+    fi
+}
+
+
+check_prereqs
+
+echo "Time in milliseconds to search 200 million characters of box lines of the given length for a shape"
+printf "%-12s%6s" "function" "shape"
+for length in "${LINE_LENGTHS[@]}"; do
+    printf "%10d" "${length}"
+done
+echo
+
+for shapeLength in "${SHAPE_LENGTHS[@]}"; do
+    for function in "${FUNCTIONS[@]}"; do
+        printf "%-12s%6d" "${function}" "${shapeLength}"
+        for length in "${LINE_LENGTHS[@]}"; do
+            printf "%10s" "$(${OUT_DIR}/search_benchmark "${function}" "${shapeLength}" "${length}")"
+        done
+        echo
+    done
+done
+
+exit 0
@@ -0,0 +1,99 @@
+#!/usr/bin/env bash
+#
+# boxes - Command line filter to draw/remove ASCII boxes around text
+# Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+#
+# This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+# License, version 3, as published by the Free Software Foundation.
+# This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+# You should have received a copy of the GNU General Public License along with this program.
+# If not, see <https://www.gnu.org/licenses/>.
+#____________________________________________________________________________________________________________________
+#
+# Measures the time needed to draw boxes around many lines of text, for designs with simple sides made of one-line,
+# single-character shapes (like 'c') and for designs with multi-line shapes. The time should grow linearly with the
+# number of lines, and all designs should take about the same time, because most of it is spent reading and writing
+# the text, not drawing the box sides. This includes designs with replacement rules (like 'c'), as long as the rules
+# do not match the text.
+#____________________________________________________________________________________________________________________
+
+set -uo pipefail
+
+# Global constants
+declare -r OUT_DIR=../out
+declare -r -a LINE_COUNTS=(1000 10000 100000 300000)
+declare -r -a DESIGNS=(c shell parchment diamonds dog)
+declare -r LINE_TEXT="The quick brown fox jumps over the lazy dog, again and again and again."
+
+
+
+function check_prereqs()
+{
+    if [ "${PWD##*/}" != "test" ]; then
+        >&2 echo "Please run this script from the test folder."
+        exit 2
+    fi
+    if [ ! -d ${OUT_DIR} ]; then
+        >&2 echo "Please run 'make' from the project root to build an executable before running benchmarks."
+        exit 2
+    fi
+}
+
+
+function get_executable_name()
+{
+    local binaryName=${OUT_DIR}/boxes.exe
+    if [ ! -x "$binaryName" ]; then
+        binaryName=${OUT_DIR}/boxes
+    fi
+    echo $binaryName
+}
+
+
+function measure_millis()
+# Args: $1 - design
+#       $2 - input file
+{
+    local start end
+    start=$(date +%s%N)
+    ${boxesBinary} -f ../boxes-config -d "$1" "$2" > /dev/null
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+
+check_prereqs
+
+declare boxesBinary
+boxesBinary=$(get_executable_name)
+
+declare inputFile
+inputFile=$(mktemp)
+trap 'rm -f "${inputFile}"' EXIT
+
+echo "Time in milliseconds to draw a box around the given number of lines"
+printf "%-12s" "design"
+for count in "${LINE_COUNTS[@]}"; do
+    printf "%10d" "${count}"
+done
+echo
+
+declare -A millis
+for count in "${LINE_COUNTS[@]}"; do
+    yes "${LINE_TEXT}" | head -n "${count}" > "${inputFile}"
+    for design in "${DESIGNS[@]}"; do
+        millis[${design},${count}]=$(measure_millis "${design}" "${inputFile}")
+    done
+done
+
+for design in "${DESIGNS[@]}"; do
+    printf "%-12s" "${design}"
+    for count in "${LINE_COUNTS[@]}"; do
+        printf "%10d" "${millis[${design},${count}]}"
+    done
+    echo
+done
+
+exit 0
@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+#
+# boxes - Command line filter to draw/remove ASCII boxes around text
+# Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+#
+# This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+# License, version 3, as published by the Free Software Foundation.
+# This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+# warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+# You should have received a copy of the GNU General Public License along with this program.
+# If not, see <https://www.gnu.org/licenses/>.
+#____________________________________________________________________________________________________________________
+#
+# Measures the time needed to draw very wide boxes. The time should grow linearly with the box width.
+#____________________________________________________________________________________________________________________
+
+set -uo pipefail
+
+# Global constants
+declare -r OUT_DIR=../out
+declare -r -a WIDTHS=(80 1000 10000 30000 100000)
+declare -r -a DESIGNS=(c parchment diamonds critical)
+
+
+
+function check_prereqs()
+{
+    if [ "${PWD##*/}" != "test" ]; then
+        >&2 echo "Please run this script from the test folder."
+        exit 2
+    fi
+    if [ ! -d ${OUT_DIR} ]; then
+        >&2 echo "Please run 'make' from the project root to build an executable before running benchmarks."
+        exit 2
+    fi
+}
+
+
+function get_executable_name()
+{
+    local binaryName=${OUT_DIR}/boxes.exe
+    if [ ! -x "$binaryName" ]; then
+        binaryName=${OUT_DIR}/boxes
+    fi
+    echo $binaryName
+}
+
+
+function measure_millis()
+# Args: $1 - design
+#       $2 - box width
+{
+    local start end
+    start=$(date +%s%N)
+    echo "benchmark" | ${boxesBinary} -f ../boxes-config -d "$1" -s "$2x5" > /dev/null
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+
+check_prereqs
+
+declare boxesBinary
+boxesBinary=$(get_executable_name)
+
+echo "Time in milliseconds to draw a box of the given width"
+printf "%-12s" "design"
+for width in "${WIDTHS[@]}"; do
+    printf "%10d" "${width}"
+done
+echo
+
+for design in "${DESIGNS[@]}"; do
+    printf "%-12s" "${design}"
+    for width in "${WIDTHS[@]}"; do
+        printf "%10d" "$(measure_millis "${design}" "${width}")"
+    done
+    echo
+done
+
+exit 0
@@ -232,6 +232,34 @@ void test_ansi_unicode_blanks(void **state)
 
 
 
+void test_ansi_unicode_ascii_padded(void **state)
+{
+    UNUSED(state);
+
+    uint32_t *ustr32 = u32_strconv_from_arg("  Hi, you!  ", "UTF-8");
+    assert_non_null(ustr32);
+    bxstr_t *actual = bxs_from_unicode(ustr32);
+
+    assert_non_null(actual);
+    assert_non_null(actual->memory);
+    assert_string_equal("  Hi, you!  ", actual->ascii);
+    assert_int_equal(2, (int) actual->indent);
+    assert_int_equal(12, (int) actual->num_columns);
+    assert_int_equal(12, (int) actual->num_chars);
+    assert_int_equal(12, (int) actual->num_chars_visible);
+    assert_int_equal(0, (int) actual->num_chars_invisible);
+    assert_int_equal(2, (int) actual->trailing);
+    int expected_firstchar_idx[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    assert_array_equal(expected_firstchar_idx, actual->first_char, 13);
+    int expected_vischar_idx[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    assert_array_equal(expected_vischar_idx, actual->visible_char, 13);
+
+    BFREE(ustr32);
+    bxs_free(actual);
+}
+
+
+
 void test_ansi_unicode_invisible_only(void **state)
 {
     UNUSED(state);
@@ -753,6 +781,55 @@ void test_bxs_substr_errors(void **state)
 
 
 
+void test_bxs_substr_inplace(void **state)
+{
+    UNUSED(state);
+
+    assert_int_equal(-1, bxs_substr_inplace(NULL, 0, 0, 0));
+
+    uint32_t *ustr32 = u32_strconv_from_arg(" x\x1b[38;5;203mx\x1b[0m\x1b[38;5;198mf\x1b[0moo", "ASCII");
+    assert_non_null(ustr32);
+    bxstr_t *actual = bxs_from_unicode(ustr32);
+
+    assert_int_equal(0, bxs_substr_inplace(actual, 18, 1000, 0));   /* same as bxs_cut_front(actual, 3) */
+    assert_string_equal("foo", actual->ascii);
+    assert_int_equal(0, (int) actual->indent);
+    assert_int_equal(3, (int) actual->num_columns);
+    assert_int_equal(18, (int) actual->num_chars);
+    assert_int_equal(3, (int) actual->num_chars_visible);
+    assert_int_equal(15, (int) actual->num_chars_invisible);
+    assert_int_equal(0, (int) actual->trailing);
+    int expected_firstchar_idx[] = {0, 16, 17, 18};
+    assert_array_equal(expected_firstchar_idx, actual->first_char, 4);
+    int expected_vischar_idx[] = {11, 16, 17, 18};
+    assert_array_equal(expected_vischar_idx, actual->visible_char, 4);
+
+    assert_int_equal(0, bxs_substr_inplace(actual, 16, 18, 3));   /* grows the string */
+    assert_string_equal("   oo", actual->ascii);
+    assert_int_equal(3, (int) actual->indent);
+    assert_int_equal(5, (int) actual->num_columns);
+    assert_int_equal(5, (int) actual->num_chars);
+    assert_int_equal(5, (int) actual->num_chars_visible);
+    assert_int_equal(0, (int) actual->num_chars_invisible);
+    assert_int_equal(0, (int) actual->trailing);
+    int expected_idx[] = {0, 1, 2, 3, 4, 5};
+    assert_array_equal(expected_idx, actual->first_char, 6);
+    assert_array_equal(expected_idx, actual->visible_char, 6);
+
+    assert_int_equal(0, bxs_substr_inplace(actual, 3, 5, 3));   /* unchanged */
+    assert_string_equal("   oo", actual->ascii);
+
+    assert_int_equal(-1, bxs_substr_inplace(actual, 3, 0, 0));   /* start_idx > end_idx */
+    assert_int_equal(1, collect_err_size);
+    assert_string_equal("boxes: internal error: end_idx before start_idx in bxs_substr_inplace()\n", collect_err[0]);
+    assert_string_equal("   oo", actual->ascii);
+
+    BFREE(ustr32);
+    bxs_free(actual);
+}
+
+
+
 void test_bxs_strcat_empty(void **state)
 {
     UNUSED(state);
@@ -1177,6 +1254,49 @@ void test_bxs_rtrim_empty(void **state)
 
 
 
+void test_bxs_rtrim_raw(void **state)
+{
+    UNUSED(state);
+
+    assert_int_equal(0, (int) bxs_rtrim_raw(NULL, 0));
+
+    const char *inputs[] = {
+        "xx\x1b[38;5;203m \x1b[0m \x1b[38;5;198m \x1b[0m ",
+        "X\x1b[38;5;203m \x1b[0mX",
+        "  X  \t ",
+        "   ",
+        "",
+        "\x1b[31m\x1b[1m X \x1b[0m",
+        "a \x1b[0m b\x1b[32m  \x1b[0m"
+    };
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        uint32_t *ustr32 = u32_strconv_from_arg(inputs[i], "UTF-8");
+        assert_non_null(ustr32);
+        bxstr_t *bxstr = bxs_from_unicode(ustr32);
+        bxstr_t *expected = bxs_rtrim(bxstr);
+        uint32_t *expected_visible = bxs_filter_visible(expected);
+
+        uint32_t *actual = u32_strdup(ustr32);
+        size_t actual_len = bxs_rtrim_raw(actual, 0);
+        assert_int_equal((int) expected->num_chars, (int) actual_len);
+        assert_int_equal(0, u32_strcmp(expected->memory, actual));
+        BFREE(actual);
+
+        actual = u32_strdup(ustr32);
+        actual_len = bxs_rtrim_raw(actual, 1);
+        assert_int_equal((int) expected->num_chars_visible, (int) actual_len);
+        assert_int_equal(0, u32_strcmp(expected_visible, actual));
+        BFREE(actual);
+
+        BFREE(expected_visible);
+        bxs_free(expected);
+        bxs_free(bxstr);
+        BFREE(ustr32);
+    }
+}
+
+
+
 void test_bxs_prepend_spaces_null(void **state)
 {
     UNUSED(state);
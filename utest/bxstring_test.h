@@ -30,6 +30,7 @@ void test_ansi_unicode_space_kinds(void **state);
 void test_ansi_unicode_chinese(void **state);
 void test_ansi_unicode_empty(void **state);
 void test_ansi_unicode_blanks(void **state);
+void test_ansi_unicode_ascii_padded(void **state);
 void test_ansi_unicode_invisible_only(void **state);
 void test_ansi_unicode_illegalchar(void **state);
 void test_ansi_unicode_tabs(void **state);
@@ -62,6 +63,7 @@ void test_bxs_trimdup_ansi(void **state);
 void test_bxs_trimdup_ansi_same(void **state);
 
 void test_bxs_substr_errors(void **state);
+void test_bxs_substr_inplace(void **state);
 
 void test_bxs_strcat(void **state);
 void test_bxs_strcat_empty(void **state);
@@ -83,6 +85,7 @@ void test_bxs_ltrim_max(void **state);
 
 void test_bxs_rtrim(void **state);
 void test_bxs_rtrim_empty(void **state);
+void test_bxs_rtrim_raw(void **state);
 
 void test_bxs_prepend_spaces_null(void **state);
 
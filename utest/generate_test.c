@@ -0,0 +1,463 @@
+/*
+ * boxes - Command line filter to draw/remove ASCII boxes around text
+ * Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License, version 3, as published by the Free Software Foundation.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ */
+
+/*
+ * Unit tests of the 'generate' module
+ */
+
+#include "config.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "boxes.h"
+#include "shape.h"
+#include "tools.h"
+#include "generate_test.h"
+#include "global_mock.h"
+
+
+/* A shape is considered empty unless it has characters, but their contents do not matter for precalc. */
+static char *dummy_chars[] = {"x"};
+static bxstr_t *dummy_mbcs[] = {NULL};
+
+static design_t test_design;
+
+
+
+static void set_shape(sentry_t *sarr, shape_t name, size_t width, size_t height, int elastic)
+{
+    sarr[name].name = name;
+    sarr[name].chars = dummy_chars;
+    sarr[name].mbcs = dummy_mbcs;
+    sarr[name].width = width;
+    sarr[name].height = height;
+    sarr[name].elastic = elastic;
+}
+
+
+
+static void setup_design(size_t maxline, size_t num_lines)
+{
+    memset(&test_design, 0, sizeof(design_t));
+    for (int i = 0; i < NUM_SHAPES; ++i) {
+        test_design.shape[i] = SENTRY_INITIALIZER;
+    }
+    set_shape(test_design.shape, NW, 1, 1, 0);
+    set_shape(test_design.shape, NE, 1, 1, 0);
+    set_shape(test_design.shape, SE, 1, 1, 0);
+    set_shape(test_design.shape, SW, 1, 1, 0);
+    test_design.minwidth = 2;
+    test_design.minheight = 2;
+
+    opt.design = &test_design;
+    input.maxline = maxline;
+    input.num_lines = num_lines;
+}
+
+
+
+static size_t size_of(const sentry_t *shape, int vertical)
+{
+    return vertical ? shape->height : shape->width;
+}
+
+
+
+/**
+ * The step-by-step algorithm by which the sizes of two opposite box sides were calculated before they were calculated
+ * in closed form. The side which is behind is extended until both sides have the same size, which is at least the
+ * target size. Kept here as the reference which the closed form must reproduce.
+ * @return == 0 on success; != 0 if the sides do not get the same size within a reasonable number of steps
+ */
+static int stepwise_precalc(const sentry_t *sarr, const shape_t *side1, const shape_t *side2, int vertical,
+                            size_t target, size_t *iltf1, size_t *iltf2, size_t *space)
+{
+    int numsh1 = 0;
+    int numsh2 = 0;
+    for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+        if (!isempty(sarr + side1[i])) {
+            numsh1++;
+        }
+        if (!isempty(sarr + side2[i])) {
+            numsh2++;
+        }
+    }
+
+    memset(iltf1, 0, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
+    memset(iltf2, 0, (SHAPES_PER_SIDE - 2) * sizeof(size_t));
+    size_t size1 = 0;
+    size_t size2 = 0;
+    int toggle1 = 1;
+    int toggle2 = 1;
+    int steps = 0;
+
+    do {
+        const shape_t *seite = side1;
+        size_t *iltf = iltf1;
+        size_t *res_space = &size1;
+        int *stoggle = &toggle1;
+        int numsh = numsh1;
+        if (size1 > size2) {
+            seite = side2;
+            iltf = iltf2;
+            res_space = &size2;
+            stoggle = &toggle2;
+            numsh = numsh2;
+        }
+
+        switch (numsh) {
+            case 1:
+                for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+                    if (!isempty(sarr + seite[i])) {
+                        if (iltf[i - 1] == 0 || *res_space < target || size1 != size2) {
+                            iltf[i - 1] += size_of(sarr + seite[i], vertical);
+                            *res_space += size_of(sarr + seite[i], vertical);
+                        }
+                        break;
+                    }
+                }
+                break;
+
+            case 2:
+                for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+                    if (!isempty(sarr + seite[i]) && !(sarr[seite[i]].elastic) && iltf[i - 1] == 0) {
+                        iltf[i - 1] += size_of(sarr + seite[i], vertical);
+                        *res_space += size_of(sarr + seite[i], vertical);
+                        break;
+                    }
+                }
+                for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+                    if (!isempty(sarr + seite[i]) && sarr[seite[i]].elastic) {
+                        if (iltf[i - 1] == 0 || *res_space < target || size1 != size2) {
+                            iltf[i - 1] += size_of(sarr + seite[i], vertical);
+                            *res_space += size_of(sarr + seite[i], vertical);
+                        }
+                        break;
+                    }
+                }
+                break;
+
+            case 3:
+                for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+                    if (!(sarr[seite[i]].elastic) && iltf[i - 1] == 0) {
+                        iltf[i - 1] += size_of(sarr + seite[i], vertical);
+                        *res_space += size_of(sarr + seite[i], vertical);
+                    }
+                }
+                if (sarr[seite[1]].elastic && sarr[seite[3]].elastic) {
+                    if (iltf[*stoggle - 1] == 0 || *res_space < target || size1 != size2) {
+                        *res_space += size_of(sarr + seite[*stoggle], vertical);
+                        iltf[*stoggle - 1] += size_of(sarr + seite[*stoggle], vertical);
+                    }
+                    *stoggle = *stoggle == 1 ? 3 : 1;
+                }
+                else {
+                    for (int i = 1; i < SHAPES_PER_SIDE - 1; ++i) {
+                        if (sarr[seite[i]].elastic) {
+                            if (iltf[i - 1] == 0 || *res_space < target || size1 != size2) {
+                                iltf[i - 1] += size_of(sarr + seite[i], vertical);
+                                *res_space += size_of(sarr + seite[i], vertical);
+                            }
+                            break;
+                        }
+                    }
+                }
+                break;
+
+            default:
+                return 1;
+        }
+        if (++steps > 1000) {
+            return 1;
+        }
+    } while (size1 != size2 || size1 < target || size2 < target);
+
+    *space = size1;
+    return 0;
+}
+
+
+
+static unsigned int next_random(unsigned int *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7fff;
+}
+
+
+
+/**
+ * Populate the middle shapes of one side with a random, but valid combination of shapes. There may be one to three
+ * shapes. Exactly one of them is elastic, except if there are three, in which case the two outer ones may be elastic.
+ */
+static void random_side(sentry_t *sarr, const shape_t *seite, unsigned int *seed)
+{
+    int present[3] = {0, 0, 0};
+    int numsh = 1 + (int) (next_random(seed) % 3);
+    if (numsh == 3) {
+        present[0] = present[1] = present[2] = 1;
+    }
+    else if (numsh == 2) {
+        present[0] = present[1] = present[2] = 1;
+        present[next_random(seed) % 3] = 0;
+    }
+    else {
+        present[next_random(seed) % 3] = 1;
+    }
+
+    int elastic[3] = {0, 0, 0};
+    if (numsh == 3 && next_random(seed) % 2 == 0) {
+        elastic[0] = elastic[2] = 1;
+    }
+    else {
+        int which;
+        do {
+            which = (int) (next_random(seed) % 3);
+        } while (!present[which]);
+        elastic[which] = 1;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        sarr[seite[i + 1]] = SENTRY_INITIALIZER;
+        if (present[i]) {
+            set_shape(sarr, seite[i + 1], 1 + next_random(seed) % 4, 1 + next_random(seed) % 4, elastic[i]);
+        }
+    }
+}
+
+
+
+void test_horiz_precalc_simple(void **state)
+{
+    UNUSED(state);
+
+    setup_design(10, 1);
+    set_shape(test_design.shape, NNW, 2, 1, 0);
+    set_shape(test_design.shape, N, 1, 1, 1);
+    set_shape(test_design.shape, S, 3, 1, 1);
+
+    size_t topiltf[SHAPES_PER_SIDE - 2];
+    size_t botiltf[SHAPES_PER_SIDE - 2];
+    size_t hspace = 0;
+    int rc = horiz_precalc(test_design.shape, topiltf, botiltf, &hspace);
+
+    assert_int_equal(0, rc);
+    assert_int_equal(12, (int) hspace);
+    assert_int_equal(2, (int) topiltf[0]);
+    assert_int_equal(10, (int) topiltf[1]);
+    assert_int_equal(0, (int) topiltf[2]);
+    assert_int_equal(0, (int) botiltf[0]);
+    assert_int_equal(12, (int) botiltf[1]);
+    assert_int_equal(0, (int) botiltf[2]);
+}
+
+
+
+void test_horiz_precalc_two_elastics(void **state)
+{
+    UNUSED(state);
+
+    setup_design(5, 1);
+    set_shape(test_design.shape, NNW, 1, 1, 1);
+    set_shape(test_design.shape, N, 2, 1, 0);
+    set_shape(test_design.shape, NNE, 2, 1, 1);
+    set_shape(test_design.shape, S, 1, 1, 1);
+
+    size_t topiltf[SHAPES_PER_SIDE - 2];
+    size_t botiltf[SHAPES_PER_SIDE - 2];
+    size_t hspace = 0;
+    int rc = horiz_precalc(test_design.shape, topiltf, botiltf, &hspace);
+
+    assert_int_equal(0, rc);
+    assert_int_equal(5, (int) hspace);
+    assert_int_equal(1, (int) topiltf[0]);
+    assert_int_equal(2, (int) topiltf[1]);
+    assert_int_equal(2, (int) topiltf[2]);
+    assert_int_equal(5, (int) botiltf[1]);
+}
+
+
+
+void test_horiz_precalc_huge(void **state)
+{
+    UNUSED(state);
+
+    setup_design(1000000000, 1);
+    set_shape(test_design.shape, N, 1, 1, 1);
+    set_shape(test_design.shape, S, 3, 1, 1);
+
+    size_t topiltf[SHAPES_PER_SIDE - 2];
+    size_t botiltf[SHAPES_PER_SIDE - 2];
+    size_t hspace = 0;
+    int rc = horiz_precalc(test_design.shape, topiltf, botiltf, &hspace);
+
+    assert_int_equal(0, rc);
+    assert_int_equal(1000000002, (int) hspace);
+    assert_int_equal(1000000002, (int) topiltf[1]);
+    assert_int_equal(1000000002, (int) botiltf[1]);
+}
+
+
+
+void test_vert_precalc_simple(void **state)
+{
+    UNUSED(state);
+
+    setup_design(1, 4);
+    set_shape(test_design.shape, W, 1, 1, 1);
+    set_shape(test_design.shape, ENE, 1, 1, 0);
+    set_shape(test_design.shape, E, 1, 2, 1);
+
+    size_t leftiltf[SHAPES_PER_SIDE - 2];
+    size_t rightiltf[SHAPES_PER_SIDE - 2];
+    size_t vspace = 0;
+    int rc = vert_precalc(test_design.shape, leftiltf, rightiltf, &vspace);
+
+    assert_int_equal(0, rc);
+    assert_int_equal(5, (int) vspace);
+    assert_int_equal(0, (int) leftiltf[0]);
+    assert_int_equal(5, (int) leftiltf[1]);
+    assert_int_equal(0, (int) leftiltf[2]);
+    assert_int_equal(1, (int) rightiltf[0]);
+    assert_int_equal(4, (int) rightiltf[1]);
+    assert_int_equal(0, (int) rightiltf[2]);
+}
+
+
+
+void test_precalc_same_as_stepwise(void **state)
+{
+    UNUSED(state);
+
+    unsigned int seed = 42;
+    for (int design_num = 0; design_num < 2000; ++design_num) {
+        setup_design(0, 0);
+        set_shape(test_design.shape, NW, next_random(&seed) % 4, next_random(&seed) % 4, 0);
+        set_shape(test_design.shape, NE, next_random(&seed) % 4, next_random(&seed) % 4, 0);
+        set_shape(test_design.shape, SE, next_random(&seed) % 4, next_random(&seed) % 4, 0);
+        set_shape(test_design.shape, SW, next_random(&seed) % 4, next_random(&seed) % 4, 0);
+        for (int i = 0; i < NUM_SIDES; ++i) {
+            random_side(test_design.shape, sides[i], &seed);
+        }
+        size_t corner_width = test_design.shape[NW].width + test_design.shape[NE].width;
+        size_t corner_height = test_design.shape[NW].height + test_design.shape[SW].height;
+
+        for (int size_num = 0; size_num < 10; ++size_num) {
+            test_design.minwidth = corner_width + next_random(&seed) % 30;
+            test_design.minheight = corner_height + next_random(&seed) % 30;
+            input.maxline = next_random(&seed) % 40;
+            input.num_lines = next_random(&seed) % 40;
+
+            size_t expected1[SHAPES_PER_SIDE - 2], expected2[SHAPES_PER_SIDE - 2], expected_space = 0;
+            size_t actual1[SHAPES_PER_SIDE - 2], actual2[SHAPES_PER_SIDE - 2], actual_space = 0;
+
+            size_t target = BMAX(input.maxline, test_design.minwidth - corner_width);
+            int expected_rc = stepwise_precalc(test_design.shape, north_side, south_side, 0, target,
+                                               expected1, expected2, &expected_space);
+            int actual_rc = horiz_precalc(test_design.shape, actual1, actual2, &actual_space);
+            assert_int_equal(expected_rc != 0, actual_rc != 0);
+            if (expected_rc == 0) {
+                assert_int_equal((int) expected_space, (int) actual_space);
+                assert_memory_equal(expected1, actual1, sizeof(expected1));
+                assert_memory_equal(expected2, actual2, sizeof(expected2));
+            }
+
+            target = BMAX(input.num_lines, test_design.minheight - corner_height);
+            expected_rc = stepwise_precalc(test_design.shape, west_side, east_side, 1, target,
+                                           expected1, expected2, &expected_space);
+            actual_rc = vert_precalc(test_design.shape, actual1, actual2, &actual_space);
+            assert_int_equal(expected_rc != 0, actual_rc != 0);
+            if (expected_rc == 0) {
+                assert_int_equal((int) expected_space, (int) actual_space);
+                assert_memory_equal(expected1, actual1, sizeof(expected1));
+                assert_memory_equal(expected2, actual2, sizeof(expected2));
+            }
+        }
+    }
+}
+
+
+
+void test_vert_side_line(void **state)
+{
+    UNUSED(state);
+
+    setup_design(0, 0);
+    set_shape(test_design.shape, NE, 1, 1, 0);
+    set_shape(test_design.shape, ENE, 1, 1, 0);
+    set_shape(test_design.shape, E, 1, 2, 1);
+    set_shape(test_design.shape, SE, 1, 2, 0);
+
+    vert_side_t side;
+    side.width = 1;
+    side.height = 9;
+    side.top = test_design.shape + NE;
+    side.fill[0] = test_design.shape + ENE;
+    side.fill[1] = test_design.shape + E;
+    side.fill[2] = test_design.shape + ESE;
+    side.fill_lines[0] = 1;
+    side.fill_lines[1] = 5;
+    side.fill_lines[2] = 0;
+    side.bottom = test_design.shape + SE;
+
+    const shape_t expected_shapes[] = {NE, ENE, E, E, E, E, E, SE, SE};
+    const size_t expected_lines[] = {0, 0, 0, 1, 0, 1, 0, 0, 1};
+    for (size_t j = 0; j < side.height; ++j) {
+        size_t shape_line = 42;
+        const sentry_t *shape = vert_side_line(&side, j, &shape_line);
+        assert_int_equal(expected_shapes[j], shape->name);
+        assert_int_equal((int) expected_lines[j], (int) shape_line);
+    }
+}
+
+
+
+void test_measure_box(void **state)
+{
+    UNUSED(state);
+
+    setup_design(5, 2);
+    set_shape(test_design.shape, N, 1, 1, 1);
+    set_shape(test_design.shape, S, 1, 1, 1);
+    set_shape(test_design.shape, W, 1, 1, 1);
+    set_shape(test_design.shape, E, 1, 1, 1);
+    test_design.minwidth = 12;
+    test_design.minheight = 6;
+    test_design.padding[BLEF] = 1;
+    test_design.padding[BRIG] = 1;
+    opt.halign = 'c';
+    opt.valign = 'c';
+
+    box_geometry_t geometry;
+    int rc = measure_box(&geometry);
+    opt.halign = '\0';
+    opt.valign = '\0';
+
+    assert_int_equal(0, rc);
+    assert_int_equal(12, (int) geometry.width);
+    assert_int_equal(6, (int) geometry.height);
+    assert_int_equal(2, (int) geometry.inset[BTOP]);
+    assert_int_equal(4, (int) geometry.inset[BRIG]);
+    assert_int_equal(2, (int) geometry.inset[BBOT]);
+    assert_int_equal(3, (int) geometry.inset[BLEF]);
+}
+
+
+/* vim: set cindent sw=4: */
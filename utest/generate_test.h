@@ -0,0 +1,45 @@
+/*
+ * boxes - Command line filter to draw/remove ASCII boxes around text
+ * Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License, version 3, as published by the Free Software Foundation.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ */
+
+/*
+ * Unit tests of the 'generate' module
+ */
+
+#ifndef GENERATE_TEST_H
+#define GENERATE_TEST_H
+
+#include "boxes.h"
+#include "generate.h"
+
+
+/* defined here and not in generate.h because these functions are only visible for testing */
+int horiz_precalc(const sentry_t *sarr, size_t *topiltf, size_t *botiltf, size_t *hspace);
+int vert_precalc(const sentry_t *sarr, size_t *leftiltf, size_t *rightiltf, size_t *vspace);
+const sentry_t *vert_side_line(const vert_side_t *side, size_t j, size_t *shape_line);
+
+
+void test_horiz_precalc_simple(void **state);
+void test_horiz_precalc_two_elastics(void **state);
+void test_horiz_precalc_huge(void **state);
+void test_vert_precalc_simple(void **state);
+void test_precalc_same_as_stepwise(void **state);
+void test_vert_side_line(void **state);
+void test_measure_box(void **state);
+
+
+#endif
+
+
+/* vim: set cindent sw=4: */
@@ -32,6 +32,7 @@
 #include "tools_test.h"
 #include "regulex_test.h"
 #include "remove_test.h"
+#include "generate_test.h"
 #include "unicode_test.h"
 
 
@@ -108,17 +109,22 @@ int main(void)
         cmocka_unit_test(test_is_ascii_id_invalid),
         cmocka_unit_test(test_is_ascii_id_strict_valid),
         cmocka_unit_test(test_is_ascii_id_strict_invalid),
-        cmocka_unit_test(test_repeat)
+        cmocka_unit_test(test_repeat),
+        cmocka_unit_test(test_num_worker_threads)
     };
 
     const struct CMUnitTest unicode_tests[] = {
         cmocka_unit_test(test_to_utf32),
+        cmocka_unit_test(test_strconv_from_arg_ascii),
         cmocka_unit_test(test_is_blank),
         cmocka_unit_test(test_is_allowed_in_sample),
         cmocka_unit_test(test_is_allowed_in_shape),
         cmocka_unit_test(test_is_allowed_in_filename),
         cmocka_unit_test(test_is_allowed_in_kv_string),
         cmocka_unit_test(test_u32_strnrstr),
+        cmocka_unit_test(test_u32_find_first),
+        cmocka_unit_test(test_u32_find_last),
+        cmocka_unit_test(test_u32_find_exhaustive),
         cmocka_unit_test(test_u32_insert_space_at)
     };
 
@@ -131,6 +137,7 @@ int main(void)
         cmocka_unit_test_setup(test_ansi_unicode_chinese, beforeTest),
         cmocka_unit_test_setup(test_ansi_unicode_empty, beforeTest),
         cmocka_unit_test_setup(test_ansi_unicode_blanks, beforeTest),
+        cmocka_unit_test_setup(test_ansi_unicode_ascii_padded, beforeTest),
         cmocka_unit_test_setup(test_ansi_unicode_invisible_only, beforeTest),
         cmocka_unit_test_setup(test_ansi_unicode_illegalchar, beforeTest),
         cmocka_unit_test_setup(test_ansi_unicode_tabs, beforeTest),
@@ -154,6 +161,7 @@ int main(void)
         cmocka_unit_test_setup(test_bxs_trimdup_ansi, beforeTest),
         cmocka_unit_test_setup(test_bxs_trimdup_ansi_same, beforeTest),
         cmocka_unit_test_setup(test_bxs_substr_errors, beforeTest),
+        cmocka_unit_test_setup(test_bxs_substr_inplace, beforeTest),
         cmocka_unit_test_setup(test_bxs_strcat, beforeTest),
         cmocka_unit_test_setup(test_bxs_strcat_empty, beforeTest),
         cmocka_unit_test_setup(test_bxs_strcat_empty2, beforeTest),
@@ -170,6 +178,7 @@ int main(void)
         cmocka_unit_test_setup(test_bxs_ltrim_max, beforeTest),
         cmocka_unit_test_setup(test_bxs_rtrim, beforeTest),
         cmocka_unit_test_setup(test_bxs_rtrim_empty, beforeTest),
+        cmocka_unit_test_setup(test_bxs_rtrim_raw, beforeTest),
         cmocka_unit_test_setup(test_bxs_prepend_spaces_null, beforeTest),
         cmocka_unit_test_setup(test_bxs_append_spaces, beforeTest),
         cmocka_unit_test_setup(test_bxs_to_output, beforeTest),
@@ -216,7 +225,10 @@ int main(void)
         cmocka_unit_test_setup(test_hmm_shortened_right_fail, beforeTest),
         cmocka_unit_test_setup(test_hmm_shortened_right, beforeTest),
         cmocka_unit_test_setup(test_hmm_blank_shiftable, beforeTest),
-        cmocka_unit_test_setup(test_hmm_blank, beforeTest)
+        cmocka_unit_test_setup(test_hmm_blank, beforeTest),
+        cmocka_unit_test_setup(test_hmm_wide_fail, beforeTest),
+        cmocka_unit_test_setup(test_hmm_wide, beforeTest),
+        cmocka_unit_test_setup(test_hmm_same_as_recursive, beforeTest)
     };
 
     const struct CMUnitTest logging_tests[] = {
@@ -238,6 +250,16 @@ int main(void)
         cmocka_unit_test_setup(test_debug_all_active, beforeTest)
     };
 
+    const struct CMUnitTest generate_tests[] = {
+        cmocka_unit_test_setup(test_horiz_precalc_simple, beforeTest),
+        cmocka_unit_test_setup(test_horiz_precalc_two_elastics, beforeTest),
+        cmocka_unit_test_setup(test_horiz_precalc_huge, beforeTest),
+        cmocka_unit_test_setup(test_vert_precalc_simple, beforeTest),
+        cmocka_unit_test_setup(test_precalc_same_as_stepwise, beforeTest),
+        cmocka_unit_test_setup(test_vert_side_line, beforeTest),
+        cmocka_unit_test_setup(test_measure_box, beforeTest)
+    };
+
     int num_failed = 0;
     num_failed += cmocka_run_group_tests(cmdline_tests, NULL, NULL);
     num_failed += cmocka_run_group_tests(regulex_tests, NULL, NULL);
@@ -245,6 +267,7 @@ int main(void)
     num_failed += cmocka_run_group_tests(unicode_tests, NULL, NULL);
     num_failed += cmocka_run_group_tests(bxstring_tests, NULL, NULL);
     num_failed += cmocka_run_group_tests(remove_tests, NULL, NULL);
+    num_failed += cmocka_run_group_tests(generate_tests, NULL, NULL);
     num_failed += cmocka_run_group_tests(logging_tests, logging_setup, logging_teardown);
 
     teardown();
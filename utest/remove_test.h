@@ -65,6 +65,9 @@ void test_hmm_shortened_right_fail(void **state);
 void test_hmm_shortened_right(void **state);
 void test_hmm_blank_shiftable(void **state);
 void test_hmm_blank(void **state);
+void test_hmm_wide_fail(void **state);
+void test_hmm_wide(void **state);
+void test_hmm_same_as_recursive(void **state);
 
 
 #endif
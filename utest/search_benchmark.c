@@ -0,0 +1,163 @@
+/*
+ * boxes - Command line filter to draw/remove ASCII boxes around text
+ * Copyright (c) 1999-2024 Thomas Jensen and the boxes contributors
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License, version 3, as published by the Free Software Foundation.
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ */
+
+/*
+ * Micro benchmark of the UTF-32 substring search, comparing `u32_find_first()` and `u32_find_last()` with the
+ * functions they replaced: `u32_strstr()` from libunistring, and the former implementation of `u32_strnrstr()`.
+ * Called by test/benchmark-substring-search.sh, which also explains the arguments.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistr.h>
+
+#include "boxes.h"
+#include "tools.h"
+#include "unicode.h"
+
+
+
+/** total number of haystack characters searched per measurement, spread over as many searches as needed */
+#define CHARS_PER_RUN 200000000L
+
+/** characters which shape lines are made of */
+static const char *shape_chars = "*-=#/";
+
+/** text of the box body, repeated as needed */
+static const char *body_text = "The quick brown fox jumps over the lazy dog, again and again. ";
+
+/** distance between partial matches of the shape in the body text */
+#define NEAR_MISS_DISTANCE 16
+
+
+
+/**
+ * The implementation of `u32_strnrstr()` before it was based on `u32_find_last()`.
+ */
+static uint32_t *old_u32_strnrstr(const uint32_t *haystack, const uint32_t *needle, const size_t needle_len)
+{
+    if (is_empty(needle)) {
+        return (uint32_t *) haystack;
+    }
+    if (is_empty(haystack)) {
+        return NULL;
+    }
+
+    uint32_t *p = u32_strrchr(haystack, needle[0]);
+    if (!p) {
+        return NULL;
+    }
+
+    while (p >= haystack) {
+        if (u32_strncmp(p, needle, needle_len) == 0) {
+            return p;
+        }
+        --p;
+    }
+
+    return NULL;
+}
+
+
+
+static uint32_t *search(const char *variant, const uint32_t *line, size_t line_len, const uint32_t *needle,
+        size_t needle_len)
+{
+    if (strcmp(variant, "strstr") == 0) {
+        return u32_strstr(line, needle);
+    }
+    if (strcmp(variant, "find_first") == 0) {
+        return u32_find_first(line, line_len, needle, needle_len);
+    }
+    if (strcmp(variant, "strnrstr") == 0) {
+        return old_u32_strnrstr(line, needle, needle_len);
+    }
+    return u32_find_last(line, line_len, needle, needle_len);
+}
+
+
+
+/**
+ * Build a line of a box: body text with the shape at the far end from where the search starts, which is where a
+ * right side shape is found by a forward search, and a left side shape by a backward search. The body text contains
+ * the shape without its last character every few positions, so that the search must reject some candidates.
+ */
+static uint32_t *build_line(const uint32_t *needle, size_t needle_len, size_t line_len, int at_start)
+{
+    uint32_t *result = (uint32_t *) calloc(line_len + 1, sizeof(uint32_t));
+    size_t text_len = strlen(body_text);
+    for (size_t i = 0; i < line_len; i++) {
+        result[i] = (uint32_t) body_text[i % text_len];
+    }
+    for (size_t i = needle_len + NEAR_MISS_DISTANCE; i + 2 * needle_len <= line_len; i += NEAR_MISS_DISTANCE) {
+        memcpy(result + i, needle, (needle_len - 1) * sizeof(uint32_t));
+    }
+    memcpy(result + (at_start ? 0 : line_len - needle_len), needle, needle_len * sizeof(uint32_t));
+    return result;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s strstr|find_first|strnrstr|find_last <shape length> <line length>\n", argv[0]);
+        return 2;
+    }
+    const char *variant = argv[1];
+    size_t needle_len = (size_t) strtol(argv[2], NULL, 10);
+    size_t line_len = (size_t) strtol(argv[3], NULL, 10);
+    if (needle_len == 0 || line_len < needle_len) {
+        fprintf(stderr, "%s: the line must be at least as long as the shape\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t *needle = (uint32_t *) calloc(needle_len + 1, sizeof(uint32_t));
+    for (size_t i = 0; i < needle_len; i++) {
+        needle[i] = (uint32_t) shape_chars[i % strlen(shape_chars)];
+    }
+    int backward = strcmp(variant, "strnrstr") == 0 || strcmp(variant, "find_last") == 0;
+    uint32_t *line = build_line(needle, needle_len, line_len, backward);
+
+    /* all variants must find the shape where it was put, or comparing them is pointless */
+    uint32_t *expected = backward ? line : line + line_len - needle_len;
+    if (search(variant, line, line_len, needle, needle_len) != expected) {
+        fprintf(stderr, "%s: %s found a different position\n", argv[0], variant);
+        return 1;
+    }
+
+    long runs = CHARS_PER_RUN / (long) line_len;
+    size_t found = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < runs; i++) {
+        found += search(variant, line, line_len, needle, needle_len) != NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long millis = (end.tv_sec - start.tv_sec) * 1000L + (end.tv_nsec - start.tv_nsec) / 1000000L;
+    printf("%ld\n", found == (size_t) runs ? millis : -1L);
+
+    BFREE(line);
+    BFREE(needle);
+    return 0;
+}
+
+
+/* vim: set cindent sw=4: */
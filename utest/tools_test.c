@@ -282,4 +282,22 @@ void test_repeat(void **state)
 }
 
 
+void test_num_worker_threads(void **state)
+{
+    (void) state; /* unused */
+
+    assert_int_equal(1, (int) num_worker_threads(0, 100, 8));
+    assert_int_equal(1, (int) num_worker_threads(199, 100, 8));
+    assert_int_equal(1, (int) num_worker_threads(1000000, 100, 1));
+
+    size_t actual = num_worker_threads(1000000, 100, 3);
+    assert_true(actual >= 1);
+    assert_true(actual <= 3);
+
+    actual = num_worker_threads(300, 100, 8);
+    assert_true(actual >= 1);
+    assert_true(actual <= 3);
+}
+
+
 /* vim: set cindent sw=4: */
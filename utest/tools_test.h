@@ -39,6 +39,8 @@ void test_is_ascii_id_strict_invalid(void **state);
 
 void test_repeat(void **state);
 
+void test_num_worker_threads(void **state);
+
 
 #endif
 
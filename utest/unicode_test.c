@@ -53,6 +53,35 @@ void test_to_utf32(void **state)
 
 
 
+void test_strconv_from_arg_ascii(void **state)
+{
+    UNUSED(state);
+
+    const uint32_t expected_ascii[] = {'a', 0x1b, '[', '1', 'm', ' ', 'b', '\n', 0};
+    uint32_t *actual = u32_strconv_from_arg("a\x1b[1m b\n", "UTF-8");
+    assert_non_null(actual);
+    assert_memory_equal(expected_ascii, actual, sizeof(expected_ascii));
+    BFREE(actual);
+
+    actual = u32_strconv_from_arg("a\x1b[1m b\n", "ISO-8859-15");
+    assert_non_null(actual);
+    assert_memory_equal(expected_ascii, actual, sizeof(expected_ascii));
+    BFREE(actual);
+
+    const uint32_t expected_umlaut[] = {'a', 0xe4, 0};
+    actual = u32_strconv_from_arg("a\xe4", "ISO-8859-15");
+    assert_non_null(actual);
+    assert_memory_equal(expected_umlaut, actual, sizeof(expected_umlaut));
+    BFREE(actual);
+
+    actual = u32_strconv_from_arg("a\xc3\xa4", "UTF-8");
+    assert_non_null(actual);
+    assert_memory_equal(expected_umlaut, actual, sizeof(expected_umlaut));
+    BFREE(actual);
+}
+
+
+
 void test_is_blank(void **state)
 {
     UNUSED(state);
@@ -182,6 +211,90 @@ void test_u32_strnrstr(void **state)
 
 
 
+void test_u32_find_first(void **state)
+{
+    UNUSED(state);
+
+    uint32_t *haystack = u32_strconv_from_arg("a foo found found bar fou", "ASCII");
+    assert_non_null(haystack);
+    uint32_t *needle = u32_strconv_from_arg("found", "ASCII");
+    assert_non_null(needle);
+    size_t haystack_len = u32_strlen(haystack);
+
+    assert_null(u32_find_first(NULL, 0, needle, 5));
+    assert_ptr_equal(haystack, u32_find_first(haystack, haystack_len, NULL, 0));
+    assert_ptr_equal(haystack + 6, u32_find_first(haystack, haystack_len, needle, 5));
+    assert_ptr_equal(haystack + 2, u32_find_first(haystack, haystack_len, needle, 2));
+    assert_ptr_equal(haystack + 12, u32_find_first(haystack + 8, haystack_len - 8, needle, 3));
+    assert_null(u32_find_first(haystack, 10, needle, 5));    /* must not look beyond the given length */
+    assert_null(u32_find_first(haystack + 22, 3, needle, 5));
+
+    BFREE(haystack);
+    BFREE(needle);
+}
+
+
+
+void test_u32_find_last(void **state)
+{
+    UNUSED(state);
+
+    uint32_t *haystack = u32_strconv_from_arg("a foo found found bar fou", "ASCII");
+    assert_non_null(haystack);
+    uint32_t *needle = u32_strconv_from_arg("found", "ASCII");
+    assert_non_null(needle);
+    size_t haystack_len = u32_strlen(haystack);
+
+    assert_null(u32_find_last(NULL, 0, needle, 5));
+    assert_ptr_equal(haystack + haystack_len, u32_find_last(haystack, haystack_len, NULL, 0));
+    assert_ptr_equal(haystack + 12, u32_find_last(haystack, haystack_len, needle, 5));
+    assert_ptr_equal(haystack + 22, u32_find_last(haystack, haystack_len, needle, 3));
+    assert_ptr_equal(haystack + 22, u32_find_last(haystack, haystack_len, needle, 1));
+    assert_ptr_equal(haystack + 6, u32_find_last(haystack, 16, needle, 5));    /* must not look beyond the length */
+    assert_null(u32_find_last(haystack, 5, needle, 5));
+
+    BFREE(haystack);
+    BFREE(needle);
+}
+
+
+
+void test_u32_find_exhaustive(void **state)
+{
+    UNUSED(state);
+
+    /* Compare against a naive search for all needles of a small alphabet, across the vector width boundaries. */
+    const uint32_t alphabet[] = {'a', 'b', 0x1F600, 'a' + 0x100};    /* last one collides with 'a' in its low byte */
+    uint32_t haystack[40];
+    for (size_t i = 0; i < 40; i++) {
+        haystack[i] = alphabet[(i * 7 + i / 5) % 4];
+    }
+    uint32_t needle[4];
+    for (size_t needle_len = 1; needle_len <= 4; needle_len++) {
+        for (size_t combo = 0; combo < (1u << (2 * needle_len)); combo++) {
+            for (size_t j = 0; j < needle_len; j++) {
+                needle[j] = alphabet[(combo >> (2 * j)) & 3];
+            }
+            for (size_t haystack_len = 0; haystack_len <= 40; haystack_len++) {
+                uint32_t *expected_first = NULL;
+                uint32_t *expected_last = NULL;
+                for (size_t i = 0; i + needle_len <= haystack_len; i++) {
+                    if (memcmp(haystack + i, needle, needle_len * sizeof(uint32_t)) == 0) {
+                        if (expected_first == NULL) {
+                            expected_first = haystack + i;
+                        }
+                        expected_last = haystack + i;
+                    }
+                }
+                assert_ptr_equal(expected_first, u32_find_first(haystack, haystack_len, needle, needle_len));
+                assert_ptr_equal(expected_last, u32_find_last(haystack, haystack_len, needle, needle_len));
+            }
+        }
+    }
+}
+
+
+
 void test_u32_insert_space_at(void **state)
 {
     UNUSED(state);
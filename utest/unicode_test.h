@@ -22,12 +22,16 @@
 
 
 void test_to_utf32(void **state);
+void test_strconv_from_arg_ascii(void **state);
 void test_is_blank(void **state);
 void test_is_allowed_in_sample(void **state);
 void test_is_allowed_in_shape(void **state);
 void test_is_allowed_in_filename(void **state);
 void test_is_allowed_in_kv_string(void **state);
 void test_u32_strnrstr(void **state);
+void test_u32_find_first(void **state);
+void test_u32_find_last(void **state);
+void test_u32_find_exhaustive(void **state);
 void test_u32_insert_space_at(void **state);
 
 